@@ -21,6 +21,14 @@
 #include <pybind11/pybind11.h>
 
 #include <SofaGLFW/init.h>
+#include <sofa/helper/logging/Messaging.h>
+#if SOFAGLFW_HAVE_SOFA_GUI_COMMON
+#include <SofaGLFW/SofaGLFWGUI.h>
+#include <sofa/gui/common/GUIManager.h>
+#endif // SOFAGLFW_HAVE_SOFA_GUI_COMMON
+
+#include <memory>
+#include <stdexcept>
 
 
 namespace py { using namespace pybind11; }
@@ -28,9 +36,77 @@ namespace py { using namespace pybind11; }
 namespace sofaglfw::python3
 {
 
+#if SOFAGLFW_HAVE_SOFA_GUI_COMMON
+namespace
+{
+
+/// Stepping commands of the running GUI (SofaGLFW or SofaImGui)
+SteppingController& getSteppingController()
+{
+    auto* gui = dynamic_cast<SofaGLFWGUI*>(sofa::gui::common::GUIManager::getGUI());
+    if (!gui)
+    {
+        throw std::runtime_error("The stepping commands require the SofaGLFW or SofaImGui GUI to be running");
+    }
+    return gui->getBaseGUI().getSteppingController();
+}
+
+} // namespace
+#endif // SOFAGLFW_HAVE_SOFA_GUI_COMMON
+
 PYBIND11_MODULE(SofaGLFW, m)
 {
     sofaglfw::init();
+
+#if SOFAGLFW_HAVE_SOFA_GUI_COMMON
+
+    m.doc() = "Stepping commands of the GUI. The commands are queued and computed by the main loop, "
+              "whether the simulation is running or paused, without drawing the intermediate steps.";
+
+    m.def("step", [](std::size_t nbSteps) { getSteppingController().stepN(nbSteps); },
+          py::arg("nbSteps") = 1, "Compute the given number of steps.");
+    m.def("runUntilTime", [](double time) { getSteppingController().runUntilTime(time); },
+          py::arg("time"), "Run until the simulation time reaches the given time.");
+    m.def("runForWallTime", [](double duration) { getSteppingController().runForWallTime(duration); },
+          py::arg("duration"), "Run for the given wall-clock duration, in seconds.");
+    m.def("runUntilData",
+          [](const std::string& dataPath, const std::string& comparison, const std::string& value, std::size_t maxNbSteps)
+          {
+              getSteppingController().runUntil(SteppingController::dataPredicate(dataPath, comparison, value),
+                                               dataPath + " " + comparison + " " + value, maxNbSteps);
+          },
+          py::arg("dataPath"), py::arg("comparison"), py::arg("value"), py::arg("maxNbSteps") = 0,
+          "Run until the value of a Data (e.g. '@/node/object.name') compares to the given value (==, !=, <, <=, >, >=), "
+          "or for maxNbSteps steps if not 0.");
+    m.def("runUntil",
+          [](py::function predicate, const std::string& description, std::size_t maxNbSteps)
+          {
+              // the predicate is called, and released, by the thread stepping the simulation
+              std::shared_ptr<py::function> function(new py::function(std::move(predicate)), [](py::function* f)
+              {
+                  py::gil_scoped_acquire acquire;
+                  delete f;
+              });
+              getSteppingController().runUntil([function](sofa::simulation::Node*)
+              {
+                  py::gil_scoped_acquire acquire;
+                  try
+                  {
+                      return (*function)().cast<bool>();
+                  }
+                  catch (const std::exception& e)
+                  {
+                      msg_error("SofaGLFW") << "The stepping predicate failed, stopping: " << e.what();
+                      return true;
+                  }
+              }, description, maxNbSteps);
+          },
+          py::arg("predicate"), py::arg("description") = "a Python predicate", py::arg("maxNbSteps") = 0,
+          "Run until the predicate (a callable without argument) returns True, evaluated before each step, "
+          "or for maxNbSteps steps if not 0.");
+    m.def("cancelStepping", []() { getSteppingController().cancel(); }, "Discard all the stepping commands.");
+    m.def("isStepping", []() { return getSteppingController().isBusy(); }, "True while stepping commands are pending.");
+#endif // SOFAGLFW_HAVE_SOFA_GUI_COMMON
 }
 
 } // namespace sofaglfw::python3
@@ -0,0 +1,107 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU General Public License as published by the Free  *
+* Software Foundation; either version 2 of the License, or (at your option)   *
+* any later version.                                                          *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for    *
+* more details.                                                               *
+*                                                                             *
+* You should have received a copy of the GNU General Public License along     *
+* with this program. If not, see <http://www.gnu.org/licenses/>.              *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <SofaGLFW/AsyncSceneLoader.h>
+
+#include <sofa/helper/logging/Messaging.h>
+#include <sofa/simulation/Simulation.h>
+
+namespace sofaglfw
+{
+
+AsyncSceneLoader::~AsyncSceneLoader()
+{
+    if (m_thread.joinable())
+    {
+        m_thread.join();
+    }
+}
+
+bool AsyncSceneLoader::start(const std::string& fileName, bool reload, std::function<void()> onReady)
+{
+    if (isBusy())
+    {
+        msg_warning("AsyncSceneLoader") << "Cannot load " << fileName << ": " << m_result.fileName << " is still being loaded.";
+        return false;
+    }
+
+    if (m_thread.joinable())
+    {
+        m_thread.join();
+    }
+
+    m_result = Result{ nullptr, fileName, reload };
+    m_startTime = std::chrono::steady_clock::now();
+    m_phase = Phase::Loading;
+
+    m_thread = std::thread([this, onReady = std::move(onReady)]()
+    {
+        sofa::simulation::NodeSPtr root;
+        try
+        {
+            root = sofa::simulation::node::load(m_result.fileName.c_str());
+            if (root)
+            {
+                m_phase = Phase::Initializing;
+                sofa::simulation::node::initRoot(root.get());
+            }
+        }
+        catch (const std::exception& e)
+        {
+            msg_error("AsyncSceneLoader") << "Failed to load " << m_result.fileName << ": " << e.what();
+            root = nullptr;
+        }
+
+        m_result.root = root;
+        m_phase = Phase::Ready;
+
+        if (onReady)
+        {
+            onReady();
+        }
+    });
+
+    return true;
+}
+
+AsyncSceneLoader::Result AsyncSceneLoader::take()
+{
+    if (m_thread.joinable())
+    {
+        m_thread.join();
+    }
+
+    Result result = std::move(m_result);
+    m_result = Result{};
+    m_phase = Phase::Idle;
+    return result;
+}
+
+double AsyncSceneLoader::getElapsedTime() const
+{
+    if (!isBusy())
+    {
+        return 0.0;
+    }
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - m_startTime).count();
+}
+
+} // namespace sofaglfw
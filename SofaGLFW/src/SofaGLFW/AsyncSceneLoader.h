@@ -0,0 +1,86 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU General Public License as published by the Free  *
+* Software Foundation; either version 2 of the License, or (at your option)   *
+* any later version.                                                          *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for    *
+* more details.                                                               *
+*                                                                             *
+* You should have received a copy of the GNU General Public License along     *
+* with this program. If not, see <http://www.gnu.org/licenses/>.              *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#pragma once
+#include <SofaGLFW/config.h>
+
+#include <sofa/simulation/Node.h>
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <string>
+#include <thread>
+
+namespace sofaglfw
+{
+
+/**
+ * @brief Loads and initializes (initRoot) a scene on a background thread.
+ *
+ * The parts requiring an OpenGL context (initTextures, initVisual) are left to the render thread,
+ * which retrieves the new root with take() once isReady().
+ */
+class SOFAGLFW_API AsyncSceneLoader
+{
+public:
+    enum class Phase
+    {
+        Idle,
+        Loading,      ///< parsing the scene file
+        Initializing, ///< initRoot
+        Ready         ///< waiting for take()
+    };
+
+    struct Result
+    {
+        sofa::simulation::NodeSPtr root;
+        std::string fileName;
+        bool reload { false };
+    };
+
+    ~AsyncSceneLoader();
+
+    /**
+     * Start loading the scene. onReady is called from the loading thread once the scene is initialized.
+     * Returns false if a scene is already being loaded.
+     */
+    bool start(const std::string& fileName, bool reload, std::function<void()> onReady = {});
+
+    /// The new root (nullptr if the loading failed), once isReady(). The loader is then idle again.
+    Result take();
+
+    Phase getPhase() const { return m_phase.load(); }
+    bool isBusy() const { return getPhase() != Phase::Idle; }
+    bool isReady() const { return getPhase() == Phase::Ready; }
+    const std::string& getFileName() const { return m_result.fileName; }
+
+    /// Time elapsed since the start of the loading, in seconds.
+    double getElapsedTime() const;
+
+private:
+    std::thread m_thread;
+    std::atomic<Phase> m_phase { Phase::Idle };
+    Result m_result;
+    std::chrono::steady_clock::time_point m_startTime;
+};
+
+} // namespace sofaglfw
@@ -0,0 +1,232 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU General Public License as published by the Free  *
+* Software Foundation; either version 2 of the License, or (at your option)   *
+* any later version.                                                          *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for    *
+* more details.                                                               *
+*                                                                             *
+* You should have received a copy of the GNU General Public License along     *
+* with this program. If not, see <http://www.gnu.org/licenses/>.              *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <SofaGLFW/BackgroundRenderer.h>
+#include <SofaGLFW/GLSLProgram.h>
+
+#include <sofa/gl/gl.h>
+#include <sofa/helper/logging/Messaging.h>
+
+#include <algorithm>
+#include <cstddef>
+
+namespace sofaglfw
+{
+
+namespace
+{
+
+constexpr const char* vertexShaderSource = R"(
+VERTEX_IN vec2 position;
+VERTEX_IN vec2 texCoord;
+VERTEX_IN vec4 color;
+VERTEX_OUT vec2 vertexTexCoord;
+VERTEX_OUT vec4 vertexColor;
+void main()
+{
+    vertexTexCoord = texCoord;
+    vertexColor = color;
+    gl_Position = vec4(position, 0.0, 1.0);
+}
+)";
+
+constexpr const char* fragmentShaderSource = R"(
+uniform sampler2D image;
+uniform bool hasImage;
+FRAGMENT_IN vec2 vertexTexCoord;
+FRAGMENT_IN vec4 vertexColor;
+void main()
+{
+    FRAG_COLOR = hasImage ? vertexColor * texture(image, vertexTexCoord) : vertexColor;
+}
+)";
+
+struct Vertex
+{
+    GLfloat position[2];
+    GLfloat texCoord[2];
+    GLfloat color[4];
+};
+
+} // namespace
+
+bool BackgroundRenderer::init()
+{
+    if (isInitialized() || m_bInitFailed)
+    {
+        return isInitialized();
+    }
+
+    const GLuint program = GLSLProgram::create("BackgroundRenderer", vertexShaderSource, fragmentShaderSource,
+                                               { { 0, "position" }, { 1, "texCoord" }, { 2, "color" } });
+    if (program == 0)
+    {
+        m_bInitFailed = true;
+        return false;
+    }
+    m_program = program;
+    m_hasImageLocation = glGetUniformLocation(m_program, "hasImage");
+    m_imageLocation = glGetUniformLocation(m_program, "image");
+
+    glGenBuffers(1, &m_vertexBuffer);
+    glBindBuffer(GL_ARRAY_BUFFER, m_vertexBuffer);
+    glBufferData(GL_ARRAY_BUFFER, 4 * sizeof(Vertex), nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    // a core profile has no default vertex array
+    if (GLSLProgram::isCoreProfileContext())
+    {
+        glGenVertexArrays(1, &m_vertexArray);
+    }
+    m_bVerticesOutdated = true;
+
+    return true;
+}
+
+void BackgroundRenderer::setGradient(const sofa::type::RGBAColor& bottom, const sofa::type::RGBAColor& top)
+{
+    if (m_texture != 0 || bottom != m_bottomColor || top != m_topColor)
+    {
+        m_bottomColor = bottom;
+        m_topColor = top;
+        m_texture = 0;
+        m_bVerticesOutdated = true;
+    }
+}
+
+void BackgroundRenderer::setImage(unsigned int texture, int width, int height)
+{
+    const std::array<int, 2> size { std::max(1, width), std::max(1, height) };
+    if (texture != m_texture || size != m_textureSize || m_bottomColor != sofa::type::RGBAColor::white() || m_topColor != sofa::type::RGBAColor::white())
+    {
+        m_texture = texture;
+        m_textureSize = size;
+        m_bottomColor = m_topColor = sofa::type::RGBAColor::white();
+        m_bVerticesOutdated = true;
+    }
+}
+
+void BackgroundRenderer::updateVertices()
+{
+    const Region& r = m_region;
+
+    // texture coordinates in numbers of images from the bottom-left corner of the whole image, repeated by the texture
+    const GLfloat s0 = m_texture ? static_cast<GLfloat>(r.x) / m_textureSize[0] : 0.f;
+    const GLfloat s1 = m_texture ? static_cast<GLfloat>(r.x + r.width) / m_textureSize[0] : 0.f;
+    const GLfloat t0 = m_texture ? static_cast<GLfloat>(r.y) / m_textureSize[1] : 0.f;
+    const GLfloat t1 = m_texture ? static_cast<GLfloat>(r.y + r.height) / m_textureSize[1] : 0.f;
+
+    // colors of the gradient at the bottom and the top of the region
+    const auto colorAt = [this, &r](int row)
+    {
+        const float ratio = r.imageHeight > 0 ? static_cast<float>(row) / r.imageHeight : 0.f;
+        sofa::type::RGBAColor color;
+        for (int i = 0; i < 4; ++i)
+        {
+            color[i] = m_bottomColor[i] + (m_topColor[i] - m_bottomColor[i]) * ratio;
+        }
+        return color;
+    };
+    const auto bottom = colorAt(r.y);
+    const auto top = colorAt(r.y + r.height);
+
+    const Vertex vertices[4] = {
+        { { -1.f, -1.f }, { s0, t0 }, { bottom[0], bottom[1], bottom[2], bottom[3] } },
+        { {  1.f, -1.f }, { s1, t0 }, { bottom[0], bottom[1], bottom[2], bottom[3] } },
+        { { -1.f,  1.f }, { s0, t1 }, { top[0], top[1], top[2], top[3] } },
+        { {  1.f,  1.f }, { s1, t1 }, { top[0], top[1], top[2], top[3] } },
+    };
+    glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices);
+    m_bVerticesOutdated = false;
+}
+
+bool BackgroundRenderer::draw(int imageWidth, int imageHeight, int x, int y, int width, int height)
+{
+    if (!isInitialized() || width <= 0 || height <= 0)
+    {
+        return false;
+    }
+
+    const Region region { imageWidth, imageHeight, x, y, width, height };
+    if (region != m_region)
+    {
+        m_region = region;
+        m_bVerticesOutdated = true;
+    }
+
+    glDisable(GL_DEPTH_TEST);
+    glUseProgram(m_program);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, m_texture);
+    glUniform1i(m_imageLocation, 0);
+    glUniform1i(m_hasImageLocation, m_texture != 0);
+
+    if (m_vertexArray != 0)
+    {
+        glBindVertexArray(m_vertexArray);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, m_vertexBuffer);
+    if (m_bVerticesOutdated)
+    {
+        updateVertices();
+    }
+    glEnableVertexAttribArray(0);
+    glEnableVertexAttribArray(1);
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), reinterpret_cast<const void*>(offsetof(Vertex, position)));
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), reinterpret_cast<const void*>(offsetof(Vertex, texCoord)));
+    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex), reinterpret_cast<const void*>(offsetof(Vertex, color)));
+    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    glDisableVertexAttribArray(0);
+    glDisableVertexAttribArray(1);
+    glDisableVertexAttribArray(2);
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    if (m_vertexArray != 0)
+    {
+        glBindVertexArray(0);
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glUseProgram(0);
+
+    return true;
+}
+
+void BackgroundRenderer::release()
+{
+    if (!isInitialized())
+    {
+        return;
+    }
+
+    glDeleteBuffers(1, &m_vertexBuffer);
+    if (m_vertexArray != 0)
+    {
+        glDeleteVertexArrays(1, &m_vertexArray);
+    }
+    glDeleteProgram(m_program);
+    m_program = m_vertexBuffer = m_vertexArray = 0;
+    m_hasImageLocation = m_imageLocation = -1;
+    m_region = {};
+    m_bVerticesOutdated = true;
+}
+
+} // namespace sofaglfw
@@ -0,0 +1,96 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU General Public License as published by the Free  *
+* Software Foundation; either version 2 of the License, or (at your option)   *
+* any later version.                                                          *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for    *
+* more details.                                                               *
+*                                                                             *
+* You should have received a copy of the GNU General Public License along     *
+* with this program. If not, see <http://www.gnu.org/licenses/>.              *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#pragma once
+#include <SofaGLFW/config.h>
+
+#include <sofa/type/RGBAColor.h>
+
+#include <array>
+
+namespace sofaglfw
+{
+
+/**
+ * @brief Draws the background of the scene behind the 3D pass: a vertical gradient or a tiled image,
+ * as a single quad read from a vertex buffer by a shader.
+ *
+ * The vertices are only rebuilt when the background or the drawn region change (e.g. the viewport is resized),
+ * and the draw only touches the state it needs instead of saving the whole OpenGL state. A uniform color
+ * needs no draw at all: it is the color the frame is cleared with.
+ *
+ * Requires a current OpenGL context (GLSL 1.20, or a core profile, see GLSLProgram). The GPU resources must be released explicitly before the
+ * context is destroyed.
+ */
+class SOFAGLFW_API BackgroundRenderer
+{
+public:
+    BackgroundRenderer() = default;
+    ~BackgroundRenderer() = default;
+
+    BackgroundRenderer(const BackgroundRenderer&) = delete;
+    BackgroundRenderer& operator=(const BackgroundRenderer&) = delete;
+
+    /// Compile the shader and create the vertex buffer. Returns false if the context does not support it (without trying again).
+    bool init();
+    bool isInitialized() const { return m_program != 0; }
+
+    /// Vertical gradient, from the bottom of the image to its top.
+    void setGradient(const sofa::type::RGBAColor& bottom, const sofa::type::RGBAColor& top);
+    /// Image repeated from the bottom-left corner, at its size in pixels. The texture must wrap with GL_REPEAT.
+    void setImage(unsigned int texture, int width, int height);
+
+    /**
+     * Draw the region (x, y, width, height) of the background of an image of imageWidth x imageHeight pixels
+     * into the whole viewport, so that the tiles of a large image join up (see TiledRenderer).
+     * Leaves the depth test disabled, and the program, texture and array buffer unbound.
+     */
+    bool draw(int imageWidth, int imageHeight, int x, int y, int width, int height);
+
+    /// Delete the GPU resources. Must be called while the context is current.
+    void release();
+
+private:
+    void updateVertices();
+
+    struct Region
+    {
+        int imageWidth { 0 }, imageHeight { 0 }, x { 0 }, y { 0 }, width { 0 }, height { 0 };
+        bool operator==(const Region&) const = default;
+    };
+
+    unsigned int m_program { 0 };
+    bool m_bInitFailed { false };
+    unsigned int m_vertexBuffer { 0 };
+    unsigned int m_vertexArray { 0 };
+    int m_hasImageLocation { -1 };
+    int m_imageLocation { -1 };
+
+    sofa::type::RGBAColor m_bottomColor { sofa::type::RGBAColor::white() };
+    sofa::type::RGBAColor m_topColor { sofa::type::RGBAColor::white() };
+    unsigned int m_texture { 0 };
+    std::array<int, 2> m_textureSize { 0, 0 };
+
+    Region m_region;
+    bool m_bVerticesOutdated { true };
+};
+
+} // namespace sofaglfw
@@ -21,6 +21,7 @@
 ******************************************************************************/
 #pragma once
 #include <SofaGLFW/config.h>
+#include <SofaGLFW/PixelReadbackRing.h>
 #include <sofa/simulation/Node.h>
 
 #include <sofa/type/fwd.h>
@@ -38,6 +39,8 @@ class BaseGUIEngine
 public:
     
     virtual void init() = 0;
+    // apply the settings stored by the engine to the GUI, once when its window is created: the GUI setters called afterwards prevail
+    virtual void applySettings(SofaGLFWBaseGUI* baseGUI) { SOFA_UNUSED(baseGUI); }
     virtual void initBackend(GLFWwindow*) = 0;
     virtual void startFrame(SofaGLFWBaseGUI*) = 0;
     virtual void endFrame() = 0;
@@ -47,11 +50,32 @@ public:
     virtual bool isTerminated() const = 0;
     virtual bool dispatchMouseEvents() = 0;
     virtual void resetCounter() = 0;
+    // pixels (RGBA) of the frame drawn depth - 1 frames ago, where depth is the number of frames read back asynchronously
     virtual sofa::type::Vec2i getFrameBufferPixels(std::vector<uint8_t>& pixels) = 0;
+    // same frame, without copy: the pixels are shared until the last consumer releases them (nullptr if no frame is available)
+    // a non-zero imageSize different from the viewport scales the frame on the GPU before the readback
+    virtual PixelFramePtr readFrameBuffer(const sofa::type::Vec2i& imageSize = { 0, 0 }) { SOFA_UNUSED(imageSize); return nullptr; }
+    // prepare the conversion of the frames to YUV420 on the GPU (needs a current context); false if not supported
+    virtual bool initYUV420Readback() { return false; }
+    // same as readFrameBuffer, converted to YUV420 on the GPU and scaled to imageSize (see YUV420Converter::getImageSize)
+    virtual PixelFramePtr readFrameBufferYUV420(const sofa::type::Vec2i& imageSize) { SOFA_UNUSED(imageSize); return nullptr; }
+    virtual void setFrameBufferReadbackDepth(std::size_t nbFrames) { SOFA_UNUSED(nbFrames); }
+    // time (of the simulation) of the frames read from now on, handed out with them
+    virtual void setFrameBufferReadbackTime(double time) { SOFA_UNUSED(time); }
+    virtual void discardPendingFrameBufferPixels() {}
+    // oldest frame still being read back, without reading a new one (nullptr if none), e.g. to end a recording with the last frame drawn
+    virtual PixelFramePtr readPendingFrameBuffer() { return nullptr; }
     virtual void openFile(SofaGLFWBaseGUI* baseGUI, sofa::core::sptr<sofa::simulation::Node>& groot) { SOFA_UNUSED(baseGUI); SOFA_UNUSED(groot); };
     virtual void loadFile(SofaGLFWBaseGUI* baseGUI, sofa::core::sptr<sofa::simulation::Node>& groot, std::string filePathName, bool reload = false)
     { SOFA_UNUSED(baseGUI); SOFA_UNUSED(groot); SOFA_UNUSED(filePathName); SOFA_UNUSED(reload); };
     virtual void contentScaleChanged(float xscale, float yscale) { SOFA_UNUSED(xscale); SOFA_UNUSED(yscale); };
+    // true if the last drawn scene is kept between frames (e.g. in a FBO), so a frame can skip drawing the scene
+    virtual bool hasPersistentSceneFrame() const { return false; }
+    // draws the last GUI frame again without reading the scene (e.g. while a step is computed), the inputs being
+    // handled by the next frame; false if the engine cannot, the next frame is then started once the scene is available
+    virtual bool redrawLastFrame() { return false; }
+    // true if the engine only draws with shaders, so that it runs in a core profile context
+    virtual bool supportsCoreProfile() const { return false; }
 };
 
 } // namespace sofaglfw
@@ -0,0 +1,105 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU General Public License as published by the Free  *
+* Software Foundation; either version 2 of the License, or (at your option)   *
+* any later version.                                                          *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for    *
+* more details.                                                               *
+*                                                                             *
+* You should have received a copy of the GNU General Public License along     *
+* with this program. If not, see <http://www.gnu.org/licenses/>.              *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <SofaGLFW/FFMPEGVideoPipe.h>
+
+#include <sofa/helper/logging/Messaging.h>
+
+#include <sstream>
+
+#if defined(_WIN32)
+#define SOFAGLFW_POPEN _popen
+#define SOFAGLFW_PCLOSE _pclose
+#else
+#define SOFAGLFW_POPEN popen
+#define SOFAGLFW_PCLOSE pclose
+#endif
+
+namespace sofaglfw
+{
+
+FFMPEGVideoPipe::~FFMPEGVideoPipe()
+{
+    close();
+}
+
+bool FFMPEGVideoPipe::open(const std::string& ffmpegPath, const std::string& fileName, int width, int height, unsigned int framerate, unsigned int bitrate,
+                           const std::string& inputPixelFormat, const std::string& outputPixelFormat, const std::string& codec)
+{
+    close();
+
+    std::ostringstream command;
+    command << "\"" << (ffmpegPath.empty() ? std::string("ffmpeg") : ffmpegPath) << "\""
+            << " -y -loglevel error"
+            << " -f rawvideo -pix_fmt " << inputPixelFormat << " -s " << width << "x" << height << " -r " << framerate << " -i -"
+            << (codec.empty() ? std::string() : " -c:v " + codec)
+            << (inputPixelFormat == "rgba" ? " -vf vflip" : "")
+            << " -b:v " << bitrate << " -pix_fmt " << outputPixelFormat
+            << " \"" << fileName << "\"";
+
+#if defined(_WIN32)
+    // the whole command line is quoted again by cmd.exe
+    m_pipe = SOFAGLFW_POPEN(("\"" + command.str() + "\"").c_str(), "wb");
+#else
+    m_pipe = SOFAGLFW_POPEN(command.str().c_str(), "w");
+#endif
+
+    if (!m_pipe)
+    {
+        msg_error("FFMPEGVideoPipe") << "Failed to start ffmpeg: " << command.str();
+        return false;
+    }
+
+    m_fileName = fileName;
+    msg_info("FFMPEGVideoPipe") << "Recording " << inputPixelFormat << " frames into " << fileName;
+    return true;
+}
+
+bool FFMPEGVideoPipe::write(const std::uint8_t* data, std::size_t nbBytes)
+{
+    if (!m_pipe)
+    {
+        return false;
+    }
+
+    if (std::fwrite(data, 1, nbBytes, m_pipe) != nbBytes)
+    {
+        msg_error("FFMPEGVideoPipe") << "Failed to write a frame to ffmpeg (" << m_fileName << ")";
+        close();
+        return false;
+    }
+    return true;
+}
+
+void FFMPEGVideoPipe::close()
+{
+    if (m_pipe)
+    {
+        const int status = SOFAGLFW_PCLOSE(m_pipe);
+        m_pipe = nullptr;
+        if (status != 0)
+        {
+            msg_warning("FFMPEGVideoPipe") << "ffmpeg exited with status " << status << " (" << m_fileName << ")";
+        }
+    }
+}
+
+} // namespace sofaglfw
@@ -0,0 +1,69 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU General Public License as published by the Free  *
+* Software Foundation; either version 2 of the License, or (at your option)   *
+* any later version.                                                          *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for    *
+* more details.                                                               *
+*                                                                             *
+* You should have received a copy of the GNU General Public License along     *
+* with this program. If not, see <http://www.gnu.org/licenses/>.              *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#pragma once
+#include <SofaGLFW/config.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+namespace sofaglfw
+{
+
+/**
+ * @brief Writes raw frames to the standard input of an ffmpeg process, in the pixel format they were read back.
+ *
+ * sofa::gl::VideoRecorderFFMPEG only accepts RGBA frames, converted by ffmpeg, and does not choose the encoder.
+ * This pipe declares the input pixel format to ffmpeg, so that frames already converted on the GPU (e.g. yuv420p)
+ * are encoded without any conversion, and can select the encoder.
+ */
+class SOFAGLFW_API FFMPEGVideoPipe
+{
+public:
+    FFMPEGVideoPipe() = default;
+    ~FFMPEGVideoPipe();
+
+    FFMPEGVideoPipe(const FFMPEGVideoPipe&) = delete;
+    FFMPEGVideoPipe& operator=(const FFMPEGVideoPipe&) = delete;
+
+    /**
+     * Start ffmpeg, writing into fileName. An empty ffmpegPath looks for ffmpeg in the PATH, an empty codec
+     * selects the default encoder of the container. The frames are expected in inputPixelFormat (ffmpeg name),
+     * as read back by PixelReadbackRing: "rgba" rows from bottom to top, "yuv420p" rows from top to bottom.
+     */
+    bool open(const std::string& ffmpegPath, const std::string& fileName, int width, int height, unsigned int framerate, unsigned int bitrate,
+              const std::string& inputPixelFormat, const std::string& outputPixelFormat, const std::string& codec = {});
+
+    bool write(const std::uint8_t* data, std::size_t nbBytes);
+
+    /// Close the input of ffmpeg and wait for the end of the encoding.
+    void close();
+
+    bool isOpen() const { return m_pipe != nullptr; }
+
+private:
+    std::FILE* m_pipe { nullptr };
+    std::string m_fileName;
+};
+
+} // namespace sofaglfw
@@ -0,0 +1,153 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU General Public License as published by the Free  *
+* Software Foundation; either version 2 of the License, or (at your option)   *
+* any later version.                                                          *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for    *
+* more details.                                                               *
+*                                                                             *
+* You should have received a copy of the GNU General Public License along     *
+* with this program. If not, see <http://www.gnu.org/licenses/>.              *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <SofaGLFW/FrameBufferScaler.h>
+
+#include <sofa/gl/gl.h>
+
+#include <cstddef>
+
+namespace sofaglfw
+{
+
+void FrameBufferScaler::resizeTarget(unsigned int& frameBuffer, unsigned int& texture, const sofa::type::Vec2i& size, sofa::type::Vec2i& currentSize)
+{
+    if (frameBuffer == 0)
+    {
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, size[0], size[1], 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+
+        glGenFramebuffers(1, &frameBuffer);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, frameBuffer);
+        glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture, 0);
+        currentSize = size;
+    }
+    else if (currentSize != size)
+    {
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, size[0], size[1], 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        currentSize = size;
+    }
+}
+
+bool FrameBufferScaler::scaleFrameBuffer(int x, int y, int width, int height, const sofa::type::Vec2i& imageSize)
+{
+    if (width <= 0 || height <= 0 || imageSize[0] <= 0 || imageSize[1] <= 0)
+    {
+        return false;
+    }
+
+    glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &m_previousReadFrameBuffer);
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &m_previousDrawFrameBuffer);
+    GLint previousTexture = 0;
+    glGetIntegerv(GL_TEXTURE_BINDING_2D, &previousTexture);
+    const GLboolean scissorTest = glIsEnabled(GL_SCISSOR_TEST);
+    glDisable(GL_SCISSOR_TEST);
+
+    // GL_SAMPLE_BUFFERS describes the draw frame buffer
+    GLint sampleBuffers = 0;
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, static_cast<GLuint>(m_previousReadFrameBuffer));
+    glGetIntegerv(GL_SAMPLE_BUFFERS, &sampleBuffers);
+
+    if (sampleBuffers > 0)
+    {
+        resizeTarget(m_resolveFrameBuffer, m_resolveTexture, { width, height }, m_resolveSize);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, m_resolveFrameBuffer);
+        glBlitFramebuffer(x, y, x + width, y + height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, m_resolveFrameBuffer);
+        x = y = 0;
+    }
+
+    // halve the frame while it is at least twice the image size
+    sofa::type::Vec2i size { width, height };
+    for (std::size_t pass = 0; size[0] >= 2 * imageSize[0] || size[1] >= 2 * imageSize[1]; ++pass)
+    {
+        const sofa::type::Vec2i halfSize {
+            size[0] >= 2 * imageSize[0] ? size[0] / 2 : size[0],
+            size[1] >= 2 * imageSize[1] ? size[1] / 2 : size[1] };
+
+        // the first two passes are the largest: the next ones draw into a part of their frame buffers
+        const std::size_t target = pass % 2;
+        if (pass < 2)
+        {
+            resizeTarget(m_halvingFrameBuffers[target], m_halvingTextures[target], halfSize, m_halvingSizes[target]);
+        }
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, m_halvingFrameBuffers[target]);
+        glBlitFramebuffer(x, y, x + size[0], y + size[1], 0, 0, halfSize[0], halfSize[1], GL_COLOR_BUFFER_BIT, GL_LINEAR);
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, m_halvingFrameBuffers[target]);
+        x = y = 0;
+        size = halfSize;
+    }
+    width = size[0];
+    height = size[1];
+
+    resizeTarget(m_targetFrameBuffer, m_targetTexture, imageSize, m_targetSize);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, m_targetFrameBuffer);
+    glBlitFramebuffer(x, y, x + width, y + height, 0, 0, imageSize[0], imageSize[1], GL_COLOR_BUFFER_BIT, GL_LINEAR);
+
+    // the scaled frame buffer stays bound for the readback
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, m_targetFrameBuffer);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, static_cast<GLuint>(m_previousDrawFrameBuffer));
+    glBindTexture(GL_TEXTURE_2D, static_cast<GLuint>(previousTexture));
+    if (scissorTest) glEnable(GL_SCISSOR_TEST);
+
+    return true;
+}
+
+void FrameBufferScaler::unbind()
+{
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, static_cast<GLuint>(m_previousReadFrameBuffer));
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, static_cast<GLuint>(m_previousDrawFrameBuffer));
+}
+
+void FrameBufferScaler::release()
+{
+    if (m_targetFrameBuffer != 0)
+    {
+        glDeleteFramebuffers(1, &m_targetFrameBuffer);
+        glDeleteTextures(1, &m_targetTexture);
+    }
+    if (m_resolveFrameBuffer != 0)
+    {
+        glDeleteFramebuffers(1, &m_resolveFrameBuffer);
+        glDeleteTextures(1, &m_resolveTexture);
+    }
+
+    for (std::size_t i = 0; i < 2; ++i)
+    {
+        if (m_halvingFrameBuffers[i] != 0)
+        {
+            glDeleteFramebuffers(1, &m_halvingFrameBuffers[i]);
+            glDeleteTextures(1, &m_halvingTextures[i]);
+        }
+        m_halvingFrameBuffers[i] = m_halvingTextures[i] = 0;
+        m_halvingSizes[i] = { 0, 0 };
+    }
+
+    m_targetFrameBuffer = m_targetTexture = 0;
+    m_resolveFrameBuffer = m_resolveTexture = 0;
+    m_targetSize = m_resolveSize = { 0, 0 };
+}
+
+} // namespace sofaglfw
@@ -0,0 +1,81 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU General Public License as published by the Free  *
+* Software Foundation; either version 2 of the License, or (at your option)   *
+* any later version.                                                          *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for    *
+* more details.                                                               *
+*                                                                             *
+* You should have received a copy of the GNU General Public License along     *
+* with this program. If not, see <http://www.gnu.org/licenses/>.              *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#pragma once
+#include <SofaGLFW/config.h>
+
+#include <sofa/type/Vec.h>
+
+namespace sofaglfw
+{
+
+/**
+ * @brief Scales a rectangle of the frame buffer to a given image size on the GPU, so that a downscaled
+ * frame is read back with the bandwidth of its own size rather than the size of the viewport.
+ *
+ * The rectangle is blitted (linear filtering) into a RGBA8 frame buffer owned by the scaler, which is then
+ * bound for reading: the scaled frame can be read with PixelReadbackRing::readFrame(0, 0, width, height).
+ * A linear blit only averages 2x2 texels: a rectangle at least twice the image size is halved first, as many
+ * times as needed, so that all its texels contribute to the image instead of aliasing.
+ * Multisampled frame buffers are resolved first, as they cannot be scaled by a blit.
+ *
+ * Requires a current OpenGL context. The GPU resources must be released explicitly before the context is destroyed.
+ */
+class SOFAGLFW_API FrameBufferScaler
+{
+public:
+    FrameBufferScaler() = default;
+    ~FrameBufferScaler() = default;
+
+    FrameBufferScaler(const FrameBufferScaler&) = delete;
+    FrameBufferScaler& operator=(const FrameBufferScaler&) = delete;
+
+    /// Scale a rectangle of the frame buffer currently bound for reading, and bind the scaled frame buffer for reading.
+    bool scaleFrameBuffer(int x, int y, int width, int height, const sofa::type::Vec2i& imageSize);
+
+    /// Restore the frame buffer bound before the scaling, once the scaled frame has been read.
+    void unbind();
+
+    /// Delete the GPU resources. Must be called while the context is current.
+    void release();
+
+private:
+    static void resizeTarget(unsigned int& frameBuffer, unsigned int& texture, const sofa::type::Vec2i& size, sofa::type::Vec2i& currentSize);
+
+    unsigned int m_targetFrameBuffer { 0 };
+    unsigned int m_targetTexture { 0 };
+    sofa::type::Vec2i m_targetSize { 0, 0 };
+
+    // single sample copy of a multisampled frame buffer
+    unsigned int m_resolveFrameBuffer { 0 };
+    unsigned int m_resolveTexture { 0 };
+    sofa::type::Vec2i m_resolveSize { 0, 0 };
+
+    // successive halvings of the frame, alternating between two frame buffers
+    unsigned int m_halvingFrameBuffers[2] { 0, 0 };
+    unsigned int m_halvingTextures[2] { 0, 0 };
+    sofa::type::Vec2i m_halvingSizes[2] { { 0, 0 }, { 0, 0 } };
+
+    int m_previousReadFrameBuffer { 0 };
+    int m_previousDrawFrameBuffer { 0 };
+};
+
+} // namespace sofaglfw
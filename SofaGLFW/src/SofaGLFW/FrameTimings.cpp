@@ -0,0 +1,70 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU General Public License as published by the Free  *
+* Software Foundation; either version 2 of the License, or (at your option)   *
+* any later version.                                                          *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for    *
+* more details.                                                               *
+*                                                                             *
+* You should have received a copy of the GNU General Public License along     *
+* with this program. If not, see <http://www.gnu.org/licenses/>.              *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <SofaGLFW/FrameTimings.h>
+
+#include <algorithm>
+
+namespace sofaglfw
+{
+
+void FrameTimingsHistory::push(const FrameTimings& timings)
+{
+    const std::uint64_t recordIndex = m_nbRecords.load(std::memory_order_relaxed);
+    auto& slot = m_slots[recordIndex % capacity];
+
+    slot.sequence.store(2 * recordIndex + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.timings = timings;
+    slot.sequence.store(2 * (recordIndex + 1), std::memory_order_release);
+
+    m_nbRecords.store(recordIndex + 1, std::memory_order_release);
+}
+
+std::vector<FrameTimings> FrameTimingsHistory::getLatest(std::size_t maxNbRecords) const
+{
+    const std::uint64_t nbRecords = m_nbRecords.load(std::memory_order_acquire);
+    const std::uint64_t nbCopies = std::min<std::uint64_t>({ nbRecords, maxNbRecords, capacity });
+
+    std::vector<FrameTimings> records;
+    records.reserve(nbCopies);
+
+    for (std::uint64_t recordIndex = nbRecords - nbCopies; recordIndex < nbRecords; ++recordIndex)
+    {
+        const auto& slot = m_slots[recordIndex % capacity];
+
+        const std::uint64_t expectedSequence = 2 * (recordIndex + 1);
+        if (slot.sequence.load(std::memory_order_acquire) != expectedSequence)
+        {
+            continue;
+        }
+        const FrameTimings timings = slot.timings;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) != expectedSequence)
+        {
+            continue;
+        }
+        records.push_back(timings);
+    }
+    return records;
+}
+
+} // namespace sofaglfw
@@ -0,0 +1,82 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU General Public License as published by the Free  *
+* Software Foundation; either version 2 of the License, or (at your option)   *
+* any later version.                                                          *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for    *
+* more details.                                                               *
+*                                                                             *
+* You should have received a copy of the GNU General Public License along     *
+* with this program. If not, see <http://www.gnu.org/licenses/>.              *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#pragma once
+#include <SofaGLFW/config.h>
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace sofaglfw
+{
+
+/// Wall-clock time (in seconds) spent in each phase of an iteration of the main loop, summed over the windows.
+struct FrameTimings
+{
+    std::uint64_t frameIndex {0};
+    double startTime {0.0}; ///< GLFW time at the beginning of the iteration
+    std::size_t nbSteps {0}; ///< steps computed by the main loop (0 if the simulation is threaded)
+
+    double step {0.0};      ///< simulation steps and update of the visual models
+    double draw {0.0};      ///< scene rendering
+    double selection {0.0}; ///< rendering of the selected components
+    double gui {0.0};       ///< GUI engine frame
+    double readback {0.0};  ///< framebuffer read for the video recording
+    double swap {0.0};      ///< buffers swap, including the wait for the vertical synchronization
+    double poll {0.0};      ///< event processing, including the wait for the events when idle
+    double total {0.0};     ///< whole iteration
+};
+
+/**
+ * @brief Ring buffer of the timings of the last frames.
+ *
+ * Written by the main loop only, readable from any thread without locking: each slot is protected
+ * by a sequence number, and a record overwritten while being read is skipped.
+ */
+class SOFAGLFW_API FrameTimingsHistory
+{
+public:
+    static constexpr std::size_t capacity { 512 };
+
+    /// Writer side: must be called from a single thread.
+    void push(const FrameTimings& timings);
+
+    /// Copy of the last records (at most maxNbRecords), from the oldest to the most recent.
+    std::vector<FrameTimings> getLatest(std::size_t maxNbRecords = capacity) const;
+
+    /// Number of records pushed since the creation of the history.
+    std::uint64_t getNbRecords() const { return m_nbRecords.load(std::memory_order_acquire); }
+
+private:
+    struct Slot
+    {
+        std::atomic<std::uint64_t> sequence {0}; ///< odd while being written, 2 * (record index + 1) once written
+        FrameTimings timings;
+    };
+
+    std::array<Slot, capacity> m_slots;
+    std::atomic<std::uint64_t> m_nbRecords {0};
+};
+
+} // namespace sofaglfw
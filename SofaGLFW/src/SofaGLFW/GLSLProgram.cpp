@@ -0,0 +1,132 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU General Public License as published by the Free  *
+* Software Foundation; either version 2 of the License, or (at your option)   *
+* any later version.                                                          *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for    *
+* more details.                                                               *
+*                                                                             *
+* You should have received a copy of the GNU General Public License along     *
+* with this program. If not, see <http://www.gnu.org/licenses/>.              *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <SofaGLFW/GLSLProgram.h>
+
+#include <sofa/gl/gl.h>
+#include <sofa/helper/logging/Messaging.h>
+
+#include <cstdio>
+
+namespace sofaglfw
+{
+
+namespace
+{
+
+constexpr const char* legacyVertexHeader = R"(#version 120
+#define VERTEX_IN attribute
+#define VERTEX_OUT varying
+)";
+
+constexpr const char* legacyFragmentHeader = R"(#version 120
+#define FRAGMENT_IN varying
+#define FRAG_COLOR gl_FragColor
+#define texture texture2D
+)";
+
+constexpr const char* coreVertexHeader = R"(#version 330 core
+#define VERTEX_IN in
+#define VERTEX_OUT out
+)";
+
+constexpr const char* coreFragmentHeader = R"(#version 330 core
+#define FRAGMENT_IN in
+out vec4 fragColor;
+#define FRAG_COLOR fragColor
+)";
+
+GLuint compileShader(const char* owner, GLenum type, const char* header, const char* source)
+{
+    const GLuint shader = glCreateShader(type);
+    const char* sources[] = { header, source };
+    glShaderSource(shader, 2, sources, nullptr);
+    glCompileShader(shader);
+
+    GLint compiled = GL_FALSE;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
+    if (compiled != GL_TRUE)
+    {
+        GLchar log[1024] = {};
+        glGetShaderInfoLog(shader, sizeof(log), nullptr, log);
+        msg_error(owner) << "Failed to compile the shader: " << log;
+        glDeleteShader(shader);
+        return 0;
+    }
+    return shader;
+}
+
+} // namespace
+
+bool GLSLProgram::isCoreProfileContext()
+{
+    // the profile mask only exists since OpenGL 3.2
+    const auto* version = reinterpret_cast<const char*>(glGetString(GL_VERSION));
+    int major = 0;
+    int minor = 0;
+    if (!version || std::sscanf(version, "%d.%d", &major, &minor) != 2 || major * 10 + minor < 32)
+    {
+        return false;
+    }
+
+    GLint profileMask = 0;
+    glGetIntegerv(GL_CONTEXT_PROFILE_MASK, &profileMask);
+    return (profileMask & GL_CONTEXT_CORE_PROFILE_BIT) != 0;
+}
+
+unsigned int GLSLProgram::create(const char* owner, const char* vertexSource, const char* fragmentSource,
+                                 std::initializer_list<Attribute> attributes)
+{
+    const bool isCoreProfile = isCoreProfileContext();
+    const GLuint vertexShader = compileShader(owner, GL_VERTEX_SHADER, isCoreProfile ? coreVertexHeader : legacyVertexHeader, vertexSource);
+    const GLuint fragmentShader = compileShader(owner, GL_FRAGMENT_SHADER, isCoreProfile ? coreFragmentHeader : legacyFragmentHeader, fragmentSource);
+    if (vertexShader == 0 || fragmentShader == 0)
+    {
+        glDeleteShader(vertexShader);
+        glDeleteShader(fragmentShader);
+        return 0;
+    }
+
+    const GLuint program = glCreateProgram();
+    glAttachShader(program, vertexShader);
+    glAttachShader(program, fragmentShader);
+    for (const auto& attribute : attributes)
+    {
+        glBindAttribLocation(program, attribute.location, attribute.name);
+    }
+    glLinkProgram(program);
+    glDeleteShader(vertexShader);
+    glDeleteShader(fragmentShader);
+
+    GLint linked = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    if (linked != GL_TRUE)
+    {
+        GLchar log[1024] = {};
+        glGetProgramInfoLog(program, sizeof(log), nullptr, log);
+        msg_error(owner) << "Failed to link the shader: " << log;
+        glDeleteProgram(program);
+        return 0;
+    }
+    return program;
+}
+
+} // namespace sofaglfw
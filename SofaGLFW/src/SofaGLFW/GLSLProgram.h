@@ -0,0 +1,54 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU General Public License as published by the Free  *
+* Software Foundation; either version 2 of the License, or (at your option)   *
+* any later version.                                                          *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for    *
+* more details.                                                               *
+*                                                                             *
+* You should have received a copy of the GNU General Public License along     *
+* with this program. If not, see <http://www.gnu.org/licenses/>.              *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#pragma once
+#include <SofaGLFW/config.h>
+
+#include <initializer_list>
+
+namespace sofaglfw
+{
+
+/**
+ * @brief Shader programs of the viewer, running in legacy (compatibility) and core profile contexts alike.
+ *
+ * The sources are written once, without a #version line: they are compiled as GLSL 1.20, or as GLSL 3.30
+ * in a core profile context. They declare their inputs and outputs with the macros VERTEX_IN, VERTEX_OUT and
+ * FRAGMENT_IN, write the color of the fragment into FRAG_COLOR, and sample textures with texture().
+ */
+class SOFAGLFW_API GLSLProgram
+{
+public:
+    struct Attribute
+    {
+        unsigned int location;
+        const char* name;
+    };
+
+    /// True if the current context is a core profile one: no fixed-function pipeline, and vertex array objects required.
+    static bool isCoreProfileContext();
+
+    /// Compile and link the program, for the profile of the current context. Returns 0 on failure, reported as an error of the owner.
+    static unsigned int create(const char* owner, const char* vertexSource, const char* fragmentSource,
+                               std::initializer_list<Attribute> attributes);
+};
+
+} // namespace sofaglfw
@@ -0,0 +1,67 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU General Public License as published by the Free  *
+* Software Foundation; either version 2 of the License, or (at your option)   *
+* any later version.                                                          *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for    *
+* more details.                                                               *
+*                                                                             *
+* You should have received a copy of the GNU General Public License along     *
+* with this program. If not, see <http://www.gnu.org/licenses/>.              *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <SofaGLFW/InputEventQueue.h>
+
+#include <algorithm>
+
+namespace sofaglfw
+{
+
+bool InputEventQueue::push(const InputEvent& event)
+{
+    if (m_size > 0)
+    {
+        auto& last = m_events[m_size - 1];
+        if (last.type == event.type && last.window == event.window && last.shiftPressed == event.shiftPressed)
+        {
+            if (event.type == InputEvent::Type::CursorPosition)
+            {
+                // only the last position matters
+                last.x = event.x;
+                last.y = event.y;
+                return true;
+            }
+            if (event.type == InputEvent::Type::Scroll)
+            {
+                last.x += event.x;
+                last.y += event.y;
+                return true;
+            }
+        }
+    }
+
+    if (full())
+    {
+        return false;
+    }
+
+    m_events[m_size++] = event;
+    return true;
+}
+
+void InputEventQueue::clear(std::size_t nbEvents)
+{
+    std::move(m_events.begin() + nbEvents, m_events.begin() + m_size, m_events.begin());
+    m_size -= nbEvents;
+}
+
+} // namespace sofaglfw
@@ -0,0 +1,93 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU General Public License as published by the Free  *
+* Software Foundation; either version 2 of the License, or (at your option)   *
+* any later version.                                                          *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for    *
+* more details.                                                               *
+*                                                                             *
+* You should have received a copy of the GNU General Public License along     *
+* with this program. If not, see <http://www.gnu.org/licenses/>.              *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#pragma once
+#include <SofaGLFW/config.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+struct GLFWwindow;
+
+namespace sofaglfw
+{
+
+/// Mouse input received from a GLFW callback, to be handled later by the main loop.
+struct InputEvent
+{
+    enum class Type : std::uint8_t
+    {
+        CursorPosition, ///< x, y: cursor position
+        MouseButton,    ///< button, action, mods, x, y: cursor position when the button changed
+        Scroll          ///< x, y: scroll offsets
+    };
+
+    Type type { Type::CursorPosition };
+    GLFWwindow* window { nullptr };
+    double x { 0.0 };
+    double y { 0.0 };
+    int button { -1 };
+    int action { -1 };
+    int mods { 0 };
+    bool shiftPressed { false };
+};
+
+/**
+ * @brief Fixed-capacity queue of the input events received between two frames.
+ *
+ * Consecutive cursor moves (resp. scrolls) of the same window are merged, so that high-rate devices
+ * produce at most one event of each kind between two button events. Nothing is allocated.
+ */
+class SOFAGLFW_API InputEventQueue
+{
+public:
+    static constexpr std::size_t capacity { 128 };
+
+    /// Add the event, or merge it into the last one. Returns false if the queue is full.
+    bool push(const InputEvent& event);
+
+    /// Call the handler on each event in the order of reception, then empty the queue.
+    template<class Handler>
+    void dispatch(Handler&& handler)
+    {
+        // the handler may push new events: only the events queued so far are dispatched
+        const std::size_t nbEvents = m_size;
+        for (std::size_t i = 0; i < nbEvents; ++i)
+        {
+            handler(m_events[i]);
+        }
+        clear(nbEvents);
+    }
+
+    bool empty() const { return m_size == 0; }
+    bool full() const { return m_size == capacity; }
+    std::size_t size() const { return m_size; }
+
+private:
+    /// Remove the first nbEvents events.
+    void clear(std::size_t nbEvents);
+
+    std::array<InputEvent, capacity> m_events;
+    std::size_t m_size { 0 };
+};
+
+} // namespace sofaglfw
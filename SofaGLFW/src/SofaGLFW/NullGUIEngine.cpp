@@ -76,7 +76,9 @@ void NullGUIEngine::beforeDraw(GLFWwindow* window)
 
 void NullGUIEngine::terminate()
 {
-
+    m_pixelReadback.release();
+    m_yuv420Converter.release();
+    m_frameBufferScaler.release();
 }
 
 bool NullGUIEngine::dispatchMouseEvents()
@@ -93,10 +95,43 @@ sofa::type::Vec2i NullGUIEngine::getFrameBufferPixels(std::vector<uint8_t>& pixe
 {
     GLint viewport[4];
     glGetIntegerv(GL_VIEWPORT, viewport);
-    pixels.resize(viewport[2] * viewport[3] * 4);
-    glReadPixels(viewport[0], viewport[1], viewport[2], viewport[3], GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
-    
-    return {viewport[2], viewport[3]};
+
+    return m_pixelReadback.read(viewport[0], viewport[1], viewport[2], viewport[3], pixels);
+}
+
+PixelFramePtr NullGUIEngine::readFrameBuffer(const sofa::type::Vec2i& imageSize)
+{
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+
+    if (imageSize == sofa::type::Vec2i{ 0, 0 } || imageSize == sofa::type::Vec2i{ viewport[2], viewport[3] })
+    {
+        return m_pixelReadback.readFrame(viewport[0], viewport[1], viewport[2], viewport[3]);
+    }
+
+    if (!m_frameBufferScaler.scaleFrameBuffer(viewport[0], viewport[1], viewport[2], viewport[3], imageSize))
+    {
+        return nullptr;
+    }
+    auto frame = m_pixelReadback.readFrame(0, 0, imageSize[0], imageSize[1]);
+    m_frameBufferScaler.unbind();
+
+    return frame;
+}
+
+PixelFramePtr NullGUIEngine::readFrameBufferYUV420(const sofa::type::Vec2i& imageSize)
+{
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+
+    if (!m_yuv420Converter.convertFrameBuffer(viewport[0], viewport[1], viewport[2], viewport[3], imageSize))
+    {
+        return nullptr;
+    }
+    auto frame = m_pixelReadback.readFrame(0, 0, imageSize[0], imageSize[1], PixelFormat::YUV420);
+    m_yuv420Converter.unbind();
+
+    return frame;
 }
 
 } // namespace sofaglfw
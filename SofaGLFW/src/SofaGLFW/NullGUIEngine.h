@@ -23,6 +23,9 @@
 
 #include <SofaGLFW/config.h>
 #include <SofaGLFW/BaseGUIEngine.h>
+#include <SofaGLFW/PixelReadbackRing.h>
+#include <SofaGLFW/YUV420Converter.h>
+#include <SofaGLFW/FrameBufferScaler.h>
 
 namespace sofaglfw
 {
@@ -42,13 +45,24 @@ public:
     void terminate() override;
     bool isTerminated() const override { return false; };
     bool dispatchMouseEvents() override;
+    bool supportsCoreProfile() const override { return true; }
     void resetCounter() override;
     sofa::type::Vec2i getFrameBufferPixels(std::vector<uint8_t>& pixels) override;
+    PixelFramePtr readFrameBuffer(const sofa::type::Vec2i& imageSize = { 0, 0 }) override;
+    bool initYUV420Readback() override { return m_yuv420Converter.init(); }
+    PixelFramePtr readFrameBufferYUV420(const sofa::type::Vec2i& imageSize) override;
+    void setFrameBufferReadbackDepth(std::size_t nbFrames) override { m_pixelReadback.setDepth(nbFrames); }
+    void setFrameBufferReadbackTime(double time) override { m_pixelReadback.setFrameTime(time); }
+    void discardPendingFrameBufferPixels() override { m_pixelReadback.discardPendingFrames(); }
+    PixelFramePtr readPendingFrameBuffer() override { return m_pixelReadback.readPendingFrame(); }
 private:
     GLFWwindow* m_window{ nullptr };
     double m_lastTime{ 0.0 };
     double m_lastDisplayTime{ 0.0 };
     double m_avgFrameTime{ 0.0 };
+    PixelReadbackRing m_pixelReadback;
+    YUV420Converter m_yuv420Converter;
+    FrameBufferScaler m_frameBufferScaler;
 };
 
 } // namespace sofaglfw
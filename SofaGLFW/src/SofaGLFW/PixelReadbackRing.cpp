@@ -0,0 +1,204 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU General Public License as published by the Free  *
+* Software Foundation; either version 2 of the License, or (at your option)   *
+* any later version.                                                          *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for    *
+* more details.                                                               *
+*                                                                             *
+* You should have received a copy of the GNU General Public License along     *
+* with this program. If not, see <http://www.gnu.org/licenses/>.              *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <SofaGLFW/PixelReadbackRing.h>
+
+#include <sofa/gl/gl.h>
+
+#include <algorithm>
+
+namespace sofaglfw
+{
+
+PixelReadbackRing::PixelReadbackRing()
+    : m_released(std::make_shared<ReleasedBuffers>())
+{
+}
+
+void PixelReadbackRing::recycleReleasedBuffers()
+{
+    std::vector<std::size_t> released;
+    {
+        std::lock_guard lock(m_released->mutex);
+        released.swap(m_released->indices);
+    }
+
+    for (const std::size_t index : released)
+    {
+        auto& buffer = m_buffers[index];
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, buffer.id);
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        buffer.state = State::Free;
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+}
+
+std::size_t PixelReadbackRing::acquireFreeBuffer()
+{
+    const auto it = std::find_if(m_buffers.begin(), m_buffers.end(), [](const Buffer& buffer) { return buffer.state == State::Free; });
+    if (it != m_buffers.end())
+    {
+        return static_cast<std::size_t>(std::distance(m_buffers.begin(), it));
+    }
+
+    // all the buffers are in flight or held by the consumers
+    Buffer buffer;
+    glGenBuffers(1, &buffer.id);
+    m_buffers.push_back(buffer);
+    return m_buffers.size() - 1;
+}
+
+PixelFramePtr PixelReadbackRing::readFrame(int x, int y, int width, int height, PixelFormat format)
+{
+    startReadback(x, y, width, height, format);
+
+    // the oldest transfer has had depth - 1 frames to complete.
+    // After the depth has been lowered, the transfers in excess are drained at once: only the most recent one is returned
+    PixelFramePtr frame;
+    if (m_inFlight.size() >= m_depth)
+    {
+        while (m_inFlight.size() >= m_depth)
+        {
+            frame = mapOldestTransfer();
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    }
+
+    return frame;
+}
+
+void PixelReadbackRing::startReadback(int x, int y, int width, int height, PixelFormat format)
+{
+    recycleReleasedBuffers();
+
+    // start the transfer of the current frame
+    const std::size_t targetIndex = acquireFreeBuffer();
+    auto& target = m_buffers[targetIndex];
+    target.size = { std::max(0, width), std::max(0, height) };
+    target.format = format;
+    target.time = m_frameTime;
+    const std::size_t nbBytes = PixelFrame::getNbBytes(target.size, format);
+
+    // the YUV420 planes are packed 4 bytes per RGBA texel
+    const int readWidth = (format == PixelFormat::YUV420) ? target.size[0] / 4 : target.size[0];
+    const int readHeight = (format == PixelFormat::YUV420) ? target.size[1] * 3 / 2 : target.size[1];
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, target.id);
+    if (target.capacity != nbBytes)
+    {
+        glBufferData(GL_PIXEL_PACK_BUFFER, static_cast<GLsizeiptr>(nbBytes), nullptr, GL_STREAM_READ);
+        target.capacity = nbBytes;
+    }
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(x, y, readWidth, readHeight, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    target.state = State::InFlight;
+    m_inFlight.push_back(targetIndex);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+}
+
+PixelFramePtr PixelReadbackRing::readPendingFrame()
+{
+    recycleReleasedBuffers();
+    if (m_inFlight.empty())
+    {
+        return nullptr;
+    }
+
+    auto frame = mapOldestTransfer();
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    return frame;
+}
+
+PixelFramePtr PixelReadbackRing::mapOldestTransfer()
+{
+    const std::size_t oldestIndex = m_inFlight.front();
+    m_inFlight.pop_front();
+
+    auto& oldest = m_buffers[oldestIndex];
+    oldest.state = State::Free;
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, oldest.id);
+    if (oldest.capacity == 0)
+    {
+        return nullptr;
+    }
+
+    const void* data = glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
+    if (!data)
+    {
+        return nullptr;
+    }
+
+    oldest.state = State::Mapped;
+    auto* pixelFrame = new PixelFrame { static_cast<const std::uint8_t*>(data), oldest.size, oldest.format, oldest.time };
+
+    // the buffer is unmapped by the render thread, at the next readback
+    return PixelFramePtr(pixelFrame, [released = m_released, oldestIndex](const PixelFrame* f)
+    {
+        {
+            std::lock_guard lock(released->mutex);
+            released->indices.push_back(oldestIndex);
+        }
+        delete f;
+    });
+}
+
+sofa::type::Vec2i PixelReadbackRing::read(int x, int y, int width, int height, std::vector<std::uint8_t>& pixels)
+{
+    const auto frame = readFrame(x, y, width, height);
+    if (!frame)
+    {
+        return { 0, 0 };
+    }
+
+    pixels.assign(frame->data, frame->data + frame->getNbBytes());
+    return frame->size;
+}
+
+void PixelReadbackRing::discardPendingFrames()
+{
+    for (const std::size_t index : m_inFlight)
+    {
+        m_buffers[index].state = State::Free;
+    }
+    m_inFlight.clear();
+}
+
+void PixelReadbackRing::release()
+{
+    recycleReleasedBuffers();
+    for (auto& buffer : m_buffers)
+    {
+        if (buffer.state == State::Mapped)
+        {
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, buffer.id);
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        }
+        glDeleteBuffers(1, &buffer.id);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    m_buffers.clear();
+    m_inFlight.clear();
+
+    // the frames still held refer to deleted buffers: their release must not touch the new ones
+    m_released = std::make_shared<ReleasedBuffers>();
+}
+
+} // namespace sofaglfw
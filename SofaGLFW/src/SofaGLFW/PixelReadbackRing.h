@@ -0,0 +1,149 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU General Public License as published by the Free  *
+* Software Foundation; either version 2 of the License, or (at your option)   *
+* any later version.                                                          *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for    *
+* more details.                                                               *
+*                                                                             *
+* You should have received a copy of the GNU General Public License along     *
+* with this program. If not, see <http://www.gnu.org/licenses/>.              *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#pragma once
+#include <SofaGLFW/config.h>
+
+#include <sofa/type/Vec.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace sofaglfw
+{
+
+enum class PixelFormat
+{
+    RGBA,   ///< 4 bytes per pixel, rows from bottom to top
+    YUV420  ///< planar Y, U then V (BT.601, limited range), chroma subsampled by 2 in both directions, rows from top to bottom
+};
+
+/**
+ * Pixels of a frame read back from the GPU, shared by its consumers (e.g. the video encoder).
+ * The pixels stay valid, and their storage is not reused, until the last reference is released.
+ * They can be read from any thread.
+ */
+struct PixelFrame
+{
+    const std::uint8_t* data { nullptr };
+    sofa::type::Vec2i size; ///< in pixels of the image
+    PixelFormat format { PixelFormat::RGBA };
+    double time { 0.0 };    ///< see PixelReadbackRing::setFrameTime
+
+    static std::size_t getNbBytes(const sofa::type::Vec2i& size, PixelFormat format)
+    {
+        const std::size_t nbPixels = static_cast<std::size_t>(size[0]) * static_cast<std::size_t>(size[1]);
+        return format == PixelFormat::YUV420 ? nbPixels * 3 / 2 : nbPixels * 4;
+    }
+    std::size_t getNbBytes() const { return getNbBytes(size, format); }
+};
+using PixelFramePtr = std::shared_ptr<const PixelFrame>;
+
+/**
+ * @brief Asynchronous readback of the frame buffer through a pool of pixel buffer objects (PBO).
+ *
+ * Each call to readFrame() starts the transfer of the current frame into a free PBO, and hands out the
+ * oldest transfer once depth - 1 newer ones have been started: the pipeline never waits for a transfer,
+ * at the cost of depth - 1 frames of latency. The frame handed out is the mapped PBO itself, without any
+ * copy: the PBO is unmapped and reused once the frame is released. The pool grows with the number of
+ * frames held by the consumers.
+ *
+ * Requires a current OpenGL context. The PBOs must be released explicitly before the context is destroyed,
+ * after the consumers have released their frames.
+ */
+class SOFAGLFW_API PixelReadbackRing
+{
+public:
+    PixelReadbackRing();
+
+    /// Number of transfers in flight (at least 2), i.e. the latency of the frames plus one.
+    void setDepth(std::size_t nbFrames) { m_depth = nbFrames > 2 ? nbFrames : 2; }
+    std::size_t getDepth() const { return m_depth; }
+
+    /// Time (e.g. of the simulation) stamped on the frames read from now on, as they are handed out later.
+    void setFrameTime(double time) { m_frameTime = time; }
+
+    /**
+     * Start the readback of the given rectangle of the read frame buffer, and return the oldest transfer,
+     * or nullptr while the transfers fill up.
+     * With the YUV420 format, the frame buffer holds the planes packed into RGBA texels, as written by
+     * YUV420Converter: the rectangle is the size of the image, i.e. (width / 4) x (height * 3 / 2) texels.
+     */
+    PixelFramePtr readFrame(int x, int y, int width, int height, PixelFormat format = PixelFormat::RGBA);
+
+    /// Start the readback of the given rectangle without handing out any frame: collect it later with readPendingFrame().
+    void startReadback(int x, int y, int width, int height, PixelFormat format = PixelFormat::RGBA);
+
+    /// Same as readFrame, but copies the frame into pixels. Returns the size of the frame, {0, 0} (pixels unchanged) if none.
+    sofa::type::Vec2i read(int x, int y, int width, int height, std::vector<std::uint8_t>& pixels);
+
+    /// Wait for the oldest transfer in flight, without starting a new one, e.g. to collect the last frames of a recording. nullptr if none.
+    PixelFramePtr readPendingFrame();
+
+    /// Forget the transfers in flight, e.g. so that a new recording does not start with old frames.
+    void discardPendingFrames();
+
+    /// Delete the PBOs. Must be called while the context is current.
+    void release();
+
+private:
+    enum class State
+    {
+        Free,
+        InFlight, ///< transfer started
+        Mapped    ///< handed out to the consumers
+    };
+
+    struct Buffer
+    {
+        unsigned int id { 0 };
+        std::size_t capacity { 0 }; ///< allocated bytes
+        sofa::type::Vec2i size;     ///< size of the frame transferred
+        PixelFormat format { PixelFormat::RGBA };
+        double time { 0.0 };
+        State state { State::Free };
+    };
+
+    /// Buffers released by the consumers, possibly from other threads. Shared with the frames, which may outlive the ring.
+    struct ReleasedBuffers
+    {
+        std::mutex mutex;
+        std::vector<std::size_t> indices;
+    };
+
+    /// Unmap the buffers released by the consumers since the last call.
+    void recycleReleasedBuffers();
+    std::size_t acquireFreeBuffer();
+    /// Map the oldest transfer in flight, leaving its buffer bound.
+    PixelFramePtr mapOldestTransfer();
+
+    std::size_t m_depth { 2 };
+    double m_frameTime { 0.0 };
+    std::vector<Buffer> m_buffers;
+    std::deque<std::size_t> m_inFlight;
+    std::shared_ptr<ReleasedBuffers> m_released;
+};
+
+} // namespace sofaglfw
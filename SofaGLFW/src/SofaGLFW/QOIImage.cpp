@@ -0,0 +1,271 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU General Public License as published by the Free  *
+* Software Foundation; either version 2 of the License, or (at your option)   *
+* any later version.                                                          *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for    *
+* more details.                                                               *
+*                                                                             *
+* You should have received a copy of the GNU General Public License along     *
+* with this program. If not, see <http://www.gnu.org/licenses/>.              *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <SofaGLFW/QOIImage.h>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+namespace sofaglfw
+{
+
+namespace
+{
+
+constexpr std::uint8_t opIndex = 0x00;
+constexpr std::uint8_t opDiff = 0x40;
+constexpr std::uint8_t opLuma = 0x80;
+constexpr std::uint8_t opRun = 0xc0;
+constexpr std::uint8_t opRGB = 0xfe;
+constexpr std::uint8_t opRGBA = 0xff;
+constexpr std::uint8_t tagMask = 0xc0;
+
+constexpr std::size_t headerSize = 14;
+constexpr std::array<std::uint8_t, 8> endMarker { 0, 0, 0, 0, 0, 0, 0, 1 };
+
+void writeBigEndian(std::vector<std::uint8_t>& data, std::uint32_t value)
+{
+    data.push_back(static_cast<std::uint8_t>(value >> 24));
+    data.push_back(static_cast<std::uint8_t>(value >> 16));
+    data.push_back(static_cast<std::uint8_t>(value >> 8));
+    data.push_back(static_cast<std::uint8_t>(value));
+}
+
+std::uint32_t readBigEndian(const std::uint8_t* data)
+{
+    return (std::uint32_t(data[0]) << 24) | (std::uint32_t(data[1]) << 16) | (std::uint32_t(data[2]) << 8) | std::uint32_t(data[3]);
+}
+
+} // namespace
+
+QOIImage::Encoder::Encoder(int width, int height)
+    : m_width(width)
+{
+    m_data.insert(m_data.end(), { 'q', 'o', 'i', 'f' });
+    writeBigEndian(m_data, static_cast<std::uint32_t>(width));
+    writeBigEndian(m_data, static_cast<std::uint32_t>(height));
+    m_data.push_back(4); // RGBA
+    m_data.push_back(0); // sRGB with linear alpha
+}
+
+void QOIImage::Encoder::addRows(const std::uint8_t* pixels, int nbRows, bool bottomUp)
+{
+    // worst case: 5 bytes per pixel
+    m_data.reserve(m_data.size() + static_cast<std::size_t>(m_width) * nbRows * 5);
+
+    const std::size_t rowSize = static_cast<std::size_t>(m_width) * 4;
+    for (int row = 0; row < nbRows; ++row)
+    {
+        const std::uint8_t* source = pixels + rowSize * static_cast<std::size_t>(bottomUp ? nbRows - 1 - row : row);
+        for (int column = 0; column < m_width; ++column, source += 4)
+        {
+            addPixel({ source[0], source[1], source[2], source[3] });
+        }
+    }
+}
+
+void QOIImage::Encoder::addPixel(const Pixel& pixel)
+{
+    if (pixel == m_previous)
+    {
+        if (++m_run == 62)
+        {
+            m_data.push_back(opRun | (m_run - 1));
+            m_run = 0;
+        }
+        return;
+    }
+
+    if (m_run > 0)
+    {
+        m_data.push_back(opRun | (m_run - 1));
+        m_run = 0;
+    }
+
+    const std::size_t hash = pixel.hash();
+    if (m_index[hash] == pixel)
+    {
+        m_data.push_back(opIndex | static_cast<std::uint8_t>(hash));
+    }
+    else
+    {
+        m_index[hash] = pixel;
+        if (pixel.a == m_previous.a)
+        {
+            const auto dr = static_cast<std::int8_t>(pixel.r - m_previous.r);
+            const auto dg = static_cast<std::int8_t>(pixel.g - m_previous.g);
+            const auto db = static_cast<std::int8_t>(pixel.b - m_previous.b);
+            const int drg = dr - dg;
+            const int dbg = db - dg;
+
+            if (dr > -3 && dr < 2 && dg > -3 && dg < 2 && db > -3 && db < 2)
+            {
+                m_data.push_back(opDiff | static_cast<std::uint8_t>((dr + 2) << 4 | (dg + 2) << 2 | (db + 2)));
+            }
+            else if (drg > -9 && drg < 8 && dg > -33 && dg < 32 && dbg > -9 && dbg < 8)
+            {
+                m_data.push_back(opLuma | static_cast<std::uint8_t>(dg + 32));
+                m_data.push_back(static_cast<std::uint8_t>((drg + 8) << 4 | (dbg + 8)));
+            }
+            else
+            {
+                m_data.insert(m_data.end(), { opRGB, pixel.r, pixel.g, pixel.b });
+            }
+        }
+        else
+        {
+            m_data.insert(m_data.end(), { opRGBA, pixel.r, pixel.g, pixel.b, pixel.a });
+        }
+    }
+    m_previous = pixel;
+}
+
+void QOIImage::Encoder::finish()
+{
+    if (m_run > 0)
+    {
+        m_data.push_back(opRun | (m_run - 1));
+        m_run = 0;
+    }
+    m_data.insert(m_data.end(), endMarker.begin(), endMarker.end());
+}
+
+void QOIImage::encode(const std::uint8_t* pixels, int width, int height, bool bottomUp, std::vector<std::uint8_t>& data)
+{
+    Encoder encoder(width, height);
+    encoder.addRows(pixels, height, bottomUp);
+    encoder.finish();
+    data = std::move(encoder.getData());
+}
+
+bool QOIImage::decode(const std::uint8_t* data, std::size_t nbBytes, sofa::type::Vec2i& size, std::vector<std::uint8_t>& pixels)
+{
+    if (nbBytes < headerSize + endMarker.size() || std::memcmp(data, "qoif", 4) != 0)
+    {
+        return false;
+    }
+
+    const std::uint32_t width = readBigEndian(data + 4);
+    const std::uint32_t height = readBigEndian(data + 8);
+    const std::uint8_t channels = data[12];
+    // QOI limits the images to 400 million pixels
+    if (width == 0 || height == 0 || (channels != 3 && channels != 4) || height >= 400000000u / width)
+    {
+        return false;
+    }
+
+    const std::size_t nbPixels = static_cast<std::size_t>(width) * height;
+    pixels.resize(nbPixels * 4);
+
+    Pixel index[64] {};
+    Pixel pixel { 0, 0, 0, 255 };
+    std::size_t position = headerSize;
+    const std::size_t chunksEnd = nbBytes - endMarker.size();
+    std::uint8_t* destination = pixels.data();
+
+    for (std::size_t i = 0; i < nbPixels; )
+    {
+        if (position >= chunksEnd)
+        {
+            return false;
+        }
+
+        const std::uint8_t byte = data[position++];
+        std::size_t runLength = 1;
+        if (byte == opRGB)
+        {
+            if (position + 3 > chunksEnd) return false;
+            pixel.r = data[position++];
+            pixel.g = data[position++];
+            pixel.b = data[position++];
+        }
+        else if (byte == opRGBA)
+        {
+            if (position + 4 > chunksEnd) return false;
+            pixel.r = data[position++];
+            pixel.g = data[position++];
+            pixel.b = data[position++];
+            pixel.a = data[position++];
+        }
+        else if ((byte & tagMask) == opIndex)
+        {
+            pixel = index[byte];
+        }
+        else if ((byte & tagMask) == opDiff)
+        {
+            pixel.r += ((byte >> 4) & 0x03) - 2;
+            pixel.g += ((byte >> 2) & 0x03) - 2;
+            pixel.b += (byte & 0x03) - 2;
+        }
+        else if ((byte & tagMask) == opLuma)
+        {
+            if (position + 1 > chunksEnd) return false;
+            const std::uint8_t next = data[position++];
+            const int dg = (byte & 0x3f) - 32;
+            pixel.r += dg - 8 + ((next >> 4) & 0x0f);
+            pixel.g += dg;
+            pixel.b += dg - 8 + (next & 0x0f);
+        }
+        else // opRun
+        {
+            runLength = std::min<std::size_t>((byte & 0x3f) + 1, nbPixels - i);
+        }
+
+        index[pixel.hash()] = pixel;
+        for (std::size_t j = 0; j < runLength; ++j, destination += 4)
+        {
+            destination[0] = pixel.r;
+            destination[1] = pixel.g;
+            destination[2] = pixel.b;
+            destination[3] = pixel.a;
+        }
+        i += runLength;
+    }
+
+    size = { static_cast<int>(width), static_cast<int>(height) };
+    return true;
+}
+
+bool QOIImage::save(const std::string& fileName, const std::uint8_t* pixels, int width, int height, bool bottomUp)
+{
+    std::vector<std::uint8_t> data;
+    encode(pixels, width, height, bottomUp, data);
+
+    std::ofstream file(fileName, std::ios::binary);
+    file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+    return static_cast<bool>(file);
+}
+
+bool QOIImage::load(const std::string& fileName, sofa::type::Vec2i& size, std::vector<std::uint8_t>& pixels)
+{
+    std::ifstream file(fileName, std::ios::binary);
+    if (!file)
+    {
+        return false;
+    }
+    const std::vector<std::uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    return decode(data.data(), data.size(), size, pixels);
+}
+
+} // namespace sofaglfw
@@ -0,0 +1,132 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU General Public License as published by the Free  *
+* Software Foundation; either version 2 of the License, or (at your option)   *
+* any later version.                                                          *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for    *
+* more details.                                                               *
+*                                                                             *
+* You should have received a copy of the GNU General Public License along     *
+* with this program. If not, see <http://www.gnu.org/licenses/>.              *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <SofaGLFW/RealTimeSynchronizer.h>
+#include <sofa/helper/logging/Messaging.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace sofaglfw
+{
+
+const char* RealTimeSynchronizer::toString(CatchUpPolicy policy)
+{
+    return policyNames[static_cast<std::size_t>(policy)];
+}
+
+std::optional<RealTimeSynchronizer::CatchUpPolicy> RealTimeSynchronizer::policyFromString(const std::string& name)
+{
+    for (std::size_t i = 0; i < policyNames.size(); ++i)
+    {
+        if (name == policyNames[i])
+        {
+            return static_cast<CatchUpPolicy>(i);
+        }
+    }
+    return std::nullopt;
+}
+
+double RealTimeSynchronizer::getElapsedWallTime(Clock::time_point now) const
+{
+    return std::chrono::duration<double>(now - m_wallStart).count();
+}
+
+std::size_t RealTimeSynchronizer::computeNbSteps(double simulationTime, double dt)
+{
+    const auto now = Clock::now();
+
+    // a simulation time going backward means the simulation has been reset
+    if (!m_isStarted || simulationTime < m_lastSimulationTime)
+    {
+        m_isStarted = true;
+        m_wallStart = now;
+        m_simulationStart = simulationTime;
+        m_measureStart = now;
+        m_measureSimulationStart = simulationTime;
+        m_accumulatedLag.store(0.0);
+        m_droppedTime.store(0.0);
+        m_hasWarnedLate = false;
+    }
+
+    // real-time factor, measured over windows of half a second
+    constexpr double measureWindow = 0.5;
+    const double measureDuration = std::chrono::duration<double>(now - m_measureStart).count();
+    if (measureDuration >= measureWindow)
+    {
+        m_realTimeFactor.store((simulationTime - m_measureSimulationStart) / measureDuration);
+        m_measureStart = now;
+        m_measureSimulationStart = simulationTime;
+    }
+
+    m_lastSimulationTime = simulationTime;
+
+    const double elapsedWallTime = getElapsedWallTime(now);
+    const double elapsedSimulationTime = simulationTime - m_simulationStart;
+    m_accumulatedLag.store(std::max(0.0, elapsedWallTime - elapsedSimulationTime));
+
+    if (dt <= 0.0)
+    {
+        return 1;
+    }
+
+    const auto nbDueSteps = static_cast<std::size_t>(std::floor((elapsedWallTime - elapsedSimulationTime - m_droppedTime.load()) / dt));
+    if (nbDueSteps == 0)
+    {
+        return 0;
+    }
+
+    if (nbDueSteps > 1 && !m_hasWarnedLate)
+    {
+        m_hasWarnedLate = true;
+        msg_warning("RealTimeSynchronizer") << "The simulation is slower than real time (" << nbDueSteps
+            << " steps late), applying the '" << toString(m_policy) << "' catch-up policy.";
+    }
+
+    switch (m_policy)
+    {
+        case CatchUpPolicy::Drop:
+        {
+            // the steps which cannot be computed now are given up: move the time reference so that only one step is due
+            const double dropped = static_cast<double>(nbDueSteps - 1) * dt;
+            m_droppedTime.store(m_droppedTime.load() + dropped);
+            return 1;
+        }
+        case CatchUpPolicy::Burst:
+            return std::min(nbDueSteps, m_maxBurstSteps);
+        case CatchUpPolicy::SlowDown:
+        default:
+            return 1;
+    }
+}
+
+double RealTimeSynchronizer::getTimeUntilNextStep(double simulationTime, double dt) const
+{
+    if (!m_isStarted)
+    {
+        return 0.0;
+    }
+
+    const double nextStepWallTime = simulationTime + dt - m_simulationStart + m_droppedTime.load();
+    return std::max(0.0, nextStepWallTime - getElapsedWallTime(Clock::now()));
+}
+
+} // namespace sofaglfw
@@ -0,0 +1,102 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU General Public License as published by the Free  *
+* Software Foundation; either version 2 of the License, or (at your option)   *
+* any later version.                                                          *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for    *
+* more details.                                                               *
+*                                                                             *
+* You should have received a copy of the GNU General Public License along     *
+* with this program. If not, see <http://www.gnu.org/licenses/>.              *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#pragma once
+#include <SofaGLFW/config.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <optional>
+#include <string>
+
+namespace sofaglfw
+{
+
+/**
+ * @brief Paces the simulation steps so that the simulated time tracks the wall-clock time.
+ *
+ * A step of size dt is due when the simulated time after the step does not exceed the elapsed
+ * wall-clock time, so the simulation never runs ahead. When the simulation is late (steps more
+ * expensive than dt), the catch-up policy decides what to do with the missing steps.
+ */
+class SOFAGLFW_API RealTimeSynchronizer
+{
+public:
+    enum class CatchUpPolicy
+    {
+        Drop,    ///< at most one step per call, the missing time is dropped
+        Burst,   ///< up to getMaxBurstSteps() steps per call to catch up, the remaining lag is kept
+        SlowDown ///< at most one step per call, the lag is kept: the simulation runs slower than real time until it catches up
+    };
+
+    static constexpr std::array<const char*, 3> policyNames { "drop", "burst", "slowdown" };
+    static const char* toString(CatchUpPolicy policy);
+    static std::optional<CatchUpPolicy> policyFromString(const std::string& name);
+
+    void setCatchUpPolicy(CatchUpPolicy policy) { m_policy = policy; }
+    CatchUpPolicy getCatchUpPolicy() const { return m_policy; }
+    void setMaxBurstSteps(std::size_t nbSteps) { m_maxBurstSteps = nbSteps > 0 ? nbSteps : 1; }
+    std::size_t getMaxBurstSteps() const { return m_maxBurstSteps; }
+
+    /// Forget the time reference: the next call to computeNbSteps starts a new synchronization (e.g. after a pause).
+    void restart() { m_isStarted = false; }
+
+    /// Number of steps of size dt to compute now. 0 if the simulation is ahead of the wall-clock time.
+    std::size_t computeNbSteps(double simulationTime, double dt);
+
+    /// Wall-clock time (in seconds) before the next step is due, 0 if it is already due.
+    double getTimeUntilNextStep(double simulationTime, double dt) const;
+
+    /// Ratio between the simulated time and the wall-clock time, measured over the last half second.
+    double getRealTimeFactor() const { return m_realTimeFactor; }
+
+    /// Wall-clock time elapsed minus simulated time elapsed since the start of the synchronization.
+    double getAccumulatedLag() const { return m_accumulatedLag; }
+
+    /// Part of the accumulated lag that has been given up by the Drop policy.
+    double getDroppedTime() const { return m_droppedTime; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    double getElapsedWallTime(Clock::time_point now) const;
+
+    CatchUpPolicy m_policy { CatchUpPolicy::Burst };
+    std::size_t m_maxBurstSteps { 10 };
+
+    bool m_isStarted { false };
+    Clock::time_point m_wallStart;
+    double m_simulationStart { 0.0 };
+    double m_lastSimulationTime { 0.0 };
+    bool m_hasWarnedLate { false };
+
+    Clock::time_point m_measureStart;
+    double m_measureSimulationStart { 0.0 };
+
+    // written by the thread computing the steps, read by the GUI
+    std::atomic<double> m_realTimeFactor { 0.0 };
+    std::atomic<double> m_accumulatedLag { 0.0 };
+    std::atomic<double> m_droppedTime { 0.0 };
+};
+
+} // namespace sofaglfw
@@ -0,0 +1,170 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU General Public License as published by the Free  *
+* Software Foundation; either version 2 of the License, or (at your option)   *
+* any later version.                                                          *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for    *
+* more details.                                                               *
+*                                                                             *
+* You should have received a copy of the GNU General Public License along     *
+* with this program. If not, see <http://www.gnu.org/licenses/>.              *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <SofaGLFW/RecordingProfile.h>
+
+#include <sofa/helper/logging/Messaging.h>
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+namespace sofaglfw
+{
+
+sofa::type::Vec2i RecordingProfile::getVideoSize(int viewportWidth, int viewportHeight) const
+{
+    if (resolution[0] > 0 && resolution[1] > 0)
+    {
+        return resolution;
+    }
+
+    return { std::max(1, static_cast<int>(std::lround(viewportWidth * scale))),
+             std::max(1, static_cast<int>(std::lround(viewportHeight * scale))) };
+}
+
+const std::vector<RecordingProfile>& RecordingProfile::getBuiltInProfiles()
+{
+    static const std::vector<RecordingProfile> profiles = []
+    {
+        std::vector<RecordingProfile> builtIn;
+
+        RecordingProfile viewport;
+        viewport.name = "viewport";
+        builtIn.push_back(viewport);
+
+        RecordingProfile preview;
+        preview.name = "preview";
+        preview.scale = 0.25;
+        preview.framerate = 30;
+        preview.bitrate = 1000000;
+        builtIn.push_back(preview);
+
+        RecordingProfile half;
+        half.name = "half";
+        half.scale = 0.5;
+        builtIn.push_back(half);
+
+        RecordingProfile fullHD;
+        fullHD.name = "1080p";
+        fullHD.resolution = { 1920, 1080 };
+        fullHD.bitrate = 8000000;
+        builtIn.push_back(fullHD);
+
+        RecordingProfile uhd;
+        uhd.name = "2160p";
+        uhd.resolution = { 3840, 2160 };
+        uhd.bitrate = 35000000;
+        builtIn.push_back(uhd);
+
+        return builtIn;
+    }();
+    return profiles;
+}
+
+std::optional<RecordingProfile> RecordingProfile::parse(const std::string& name, const std::string& description)
+{
+    RecordingProfile profile;
+    profile.name = name;
+
+    std::string pairs = description;
+    std::replace(pairs.begin(), pairs.end(), ',', ' ');
+    std::istringstream stream(pairs);
+    std::string pair;
+    while (stream >> pair)
+    {
+        const auto separator = pair.find(':');
+        if (separator == std::string::npos)
+        {
+            msg_error("RecordingProfile") << "Profile '" << name << "': expected key:value, got '" << pair << "'";
+            return std::nullopt;
+        }
+        const std::string key = pair.substr(0, separator);
+        const std::string value = pair.substr(separator + 1);
+
+        try
+        {
+            if (key == "width")
+                profile.resolution[0] = std::stoi(value);
+            else if (key == "height")
+                profile.resolution[1] = std::stoi(value);
+            else if (key == "scale")
+                profile.scale = std::stod(value);
+            else if (key == "fps")
+                profile.framerate = static_cast<unsigned int>(std::stoul(value));
+            else if (key == "bitrate")
+                profile.bitrate = static_cast<unsigned int>(std::stoul(value));
+            else if (key == "extension")
+                profile.extension = value;
+            else if (key == "codec")
+                profile.codec = value;
+            else if (key == "pixel_format")
+                profile.pixelFormat = value;
+            else
+            {
+                msg_error("RecordingProfile") << "Profile '" << name << "': unknown key '" << key << "'";
+                return std::nullopt;
+            }
+        }
+        catch (const std::exception&)
+        {
+            msg_error("RecordingProfile") << "Profile '" << name << "': invalid value '" << value << "' for " << key;
+            return std::nullopt;
+        }
+    }
+
+    if (profile.scale <= 0.0 || profile.framerate == 0 || profile.bitrate == 0 || profile.resolution[0] < 0 || profile.resolution[1] < 0)
+    {
+        msg_error("RecordingProfile") << "Profile '" << name << "': the scale, fps, bitrate and resolution must be positive";
+        return std::nullopt;
+    }
+    return profile;
+}
+
+std::vector<RecordingProfile> RecordingProfile::load(const std::map<std::string, std::string>& iniFileValues)
+{
+    static const std::string prefix = "RECORDING_PROFILE_";
+
+    std::vector<RecordingProfile> profiles = getBuiltInProfiles();
+    for (const auto& [key, value] : iniFileValues)
+    {
+        if (key.compare(0, prefix.size(), prefix) != 0)
+        {
+            continue;
+        }
+
+        if (auto profile = parse(key.substr(prefix.size()), value))
+        {
+            const auto it = std::find_if(profiles.begin(), profiles.end(), [&profile](const RecordingProfile& p) { return p.name == profile->name; });
+            if (it != profiles.end())
+            {
+                *it = std::move(*profile);
+            }
+            else
+            {
+                profiles.push_back(std::move(*profile));
+            }
+        }
+    }
+    return profiles;
+}
+
+} // namespace sofaglfw
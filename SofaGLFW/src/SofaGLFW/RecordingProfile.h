@@ -0,0 +1,66 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU General Public License as published by the Free  *
+* Software Foundation; either version 2 of the License, or (at your option)   *
+* any later version.                                                          *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for    *
+* more details.                                                               *
+*                                                                             *
+* You should have received a copy of the GNU General Public License along     *
+* with this program. If not, see <http://www.gnu.org/licenses/>.              *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#pragma once
+#include <SofaGLFW/config.h>
+
+#include <sofa/type/Vec.h>
+
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace sofaglfw
+{
+
+/**
+ * @brief Named set of video recording parameters.
+ *
+ * Besides the built-in profiles, profiles can be declared in etc/SofaGLFW.ini, one per line, as
+ * RECORDING_PROFILE_<name>=<key>:<value> pairs separated by spaces or commas. The keys are width, height,
+ * scale, fps, bitrate, extension, codec and pixel_format. Example:
+ * RECORDING_PROFILE_preview720=height:720 width:1280 fps:30 bitrate:4000000
+ */
+struct SOFAGLFW_API RecordingProfile
+{
+    std::string name;
+    sofa::type::Vec2i resolution { 0, 0 }; ///< size of the video, {0, 0} for the size of the viewport times the scale
+    double scale { 1.0 };
+    unsigned int framerate { 60 };
+    unsigned int bitrate { 2000000 };      ///< bits per second
+    std::string extension { "mp4" };       ///< container of the video
+    std::string codec;                     ///< ffmpeg encoder, empty for the default encoder of the container
+    std::string pixelFormat { "yuv420p" }; ///< pixel format of the video
+
+    /// Size of the recorded frames for the given viewport. The frames are scaled on the GPU before the readback.
+    sofa::type::Vec2i getVideoSize(int viewportWidth, int viewportHeight) const;
+
+    static const std::vector<RecordingProfile>& getBuiltInProfiles();
+
+    /// Parse the description of a profile, see the class description. Unknown keys and invalid values are errors.
+    static std::optional<RecordingProfile> parse(const std::string& name, const std::string& description);
+
+    /// The built-in profiles, followed by the RECORDING_PROFILE_ entries of the given ini values (replacing built-in profiles of the same name).
+    static std::vector<RecordingProfile> load(const std::map<std::string, std::string>& iniFileValues);
+};
+
+} // namespace sofaglfw
@@ -0,0 +1,157 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU General Public License as published by the Free  *
+* Software Foundation; either version 2 of the License, or (at your option)   *
+* any later version.                                                          *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for    *
+* more details.                                                               *
+*                                                                             *
+* You should have received a copy of the GNU General Public License along     *
+* with this program. If not, see <http://www.gnu.org/licenses/>.              *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <SofaGLFW/ScreenshotWriter.h>
+#include <SofaGLFW/QOIImage.h>
+
+#include <sofa/helper/io/STBImage.h>
+#include <sofa/helper/logging/Messaging.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+namespace sofaglfw
+{
+
+ScreenshotWriter::~ScreenshotWriter()
+{
+    stop();
+}
+
+void ScreenshotWriter::push(PixelFramePtr frame, const std::string& fileName, int compressionLevel)
+{
+    if (!frame || frame->format != PixelFormat::RGBA || frame->getNbBytes() == 0)
+    {
+        msg_error("ScreenshotWriter") << "No pixels to write into " << fileName;
+        return;
+    }
+
+    if (m_threads.empty())
+    {
+        m_stopRequested = false;
+        m_nbWritten = 0;
+        m_nbFailed = 0;
+        const std::size_t nbThreads = (m_nbThreads > 0) ? m_nbThreads : std::max(1u, std::thread::hardware_concurrency());
+        for (std::size_t i = 0; i < nbThreads; ++i)
+        {
+            m_threads.emplace_back(&ScreenshotWriter::loop, this);
+        }
+    }
+
+    {
+        std::unique_lock lock(m_mutex);
+        m_jobTaken.wait(lock, [this] { return m_capacity == 0 || m_queue.size() < m_capacity; });
+        m_queue.push_back({ std::move(frame), fileName, compressionLevel });
+    }
+    m_jobQueued.notify_one();
+}
+
+void ScreenshotWriter::stop()
+{
+    if (m_threads.empty())
+    {
+        return;
+    }
+
+    {
+        std::lock_guard lock(m_mutex);
+        m_stopRequested = true;
+    }
+    m_jobQueued.notify_all();
+    for (auto& thread : m_threads)
+    {
+        thread.join();
+    }
+    m_threads.clear();
+}
+
+std::size_t ScreenshotWriter::getNbPending() const
+{
+    std::lock_guard lock(m_mutex);
+    return m_queue.size() + m_nbWriting;
+}
+
+std::size_t ScreenshotWriter::getNbWrittenImages() const
+{
+    std::lock_guard lock(m_mutex);
+    return m_nbWritten;
+}
+
+std::size_t ScreenshotWriter::getNbFailedImages() const
+{
+    std::lock_guard lock(m_mutex);
+    return m_nbFailed;
+}
+
+void ScreenshotWriter::loop()
+{
+    std::unique_lock lock(m_mutex);
+    while (true)
+    {
+        m_jobQueued.wait(lock, [this] { return !m_queue.empty() || m_stopRequested; });
+        if (m_queue.empty())
+        {
+            break; // stop requested and every queued screenshot is written
+        }
+
+        const Job job = std::move(m_queue.front());
+        m_queue.pop_front();
+        ++m_nbWriting;
+        lock.unlock();
+        m_jobTaken.notify_one();
+
+        const auto writeStart = std::chrono::steady_clock::now();
+        const bool written = write(*job.frame, job.fileName, job.compressionLevel);
+        if (!written)
+        {
+            msg_error("ScreenshotWriter") << "Failed to save the screenshot " << job.fileName;
+        }
+        else if (m_bLogEachImage)
+        {
+            const double writeTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - writeStart).count();
+            msg_info("ScreenshotWriter") << "Screenshot saved: " << job.fileName << " (" << job.frame->size[0] << "x" << job.frame->size[1]
+                                         << ", " << static_cast<int>(writeTime * 1000.0) << " ms)";
+        }
+
+        lock.lock();
+        --m_nbWriting;
+        ++(written ? m_nbWritten : m_nbFailed);
+    }
+}
+
+bool ScreenshotWriter::write(const PixelFrame& frame, const std::string& fileName, int compressionLevel)
+{
+    // lossless and much faster than png, e.g. to dump every frame of a render
+    if (fileName.size() > 4 && fileName.compare(fileName.size() - 4, 4, ".qoi") == 0)
+    {
+        return QOIImage::save(fileName, frame.data, frame.size[0], frame.size[1], true);
+    }
+
+    sofa::helper::io::STBImage image;
+    image.init(static_cast<unsigned int>(frame.size[0]), static_cast<unsigned int>(frame.size[1]), 1, 1,
+               sofa::helper::io::Image::DataType::UINT32, sofa::helper::io::Image::ChannelFormat::RGBA);
+    std::memcpy(image.getPixels(), frame.data, frame.getNbBytes());
+
+    return image.save(fileName, compressionLevel);
+}
+
+} // namespace sofaglfw
@@ -0,0 +1,102 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU General Public License as published by the Free  *
+* Software Foundation; either version 2 of the License, or (at your option)   *
+* any later version.                                                          *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for    *
+* more details.                                                               *
+*                                                                             *
+* You should have received a copy of the GNU General Public License along     *
+* with this program. If not, see <http://www.gnu.org/licenses/>.              *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#pragma once
+#include <SofaGLFW/config.h>
+#include <SofaGLFW/PixelReadbackRing.h>
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace sofaglfw
+{
+
+/**
+ * @brief Encodes and writes screenshots on a pool of worker threads, so that the render loop does not wait for
+ * the image encoding nor the file system.
+ *
+ * The frames are queued as read back from the GPU (RGBA, without copy), and released once written. The
+ * format (PNG, JPG, BMP, TGA) follows the extension of the file name. The images are written in parallel,
+ * hence not necessarily in the order they were queued. With a bounded queue, push() waits for room.
+ */
+class SOFAGLFW_API ScreenshotWriter
+{
+public:
+    ScreenshotWriter() = default;
+    ~ScreenshotWriter();
+
+    ScreenshotWriter(const ScreenshotWriter&) = delete;
+    ScreenshotWriter& operator=(const ScreenshotWriter&) = delete;
+
+    /// Number of worker threads (0: one per hardware thread), taken into account when the threads start.
+    void setNbThreads(std::size_t nbThreads) { m_nbThreads = nbThreads; }
+    /// Maximum number of queued images (0: unbounded).
+    void setQueueCapacity(std::size_t nbImages) { m_capacity = nbImages; }
+    /// If true (default), the end of each write is reported in the log.
+    void setLogEachImage(bool enabled) { m_bLogEachImage = enabled; }
+
+    /**
+     * Queue a frame to be written into fileName. Starts the threads if needed.
+     * compressionLevel is the zlib level (0-9) for PNG, the quality (1-100) for JPG, -1 for the default.
+     */
+    void push(PixelFramePtr frame, const std::string& fileName, int compressionLevel = 90);
+
+    /// Write the queued frames, then stop the threads.
+    void stop();
+
+    /// Number of screenshots queued or being written.
+    std::size_t getNbPending() const;
+    /// Number of images written, or which could not be written, since the threads started.
+    std::size_t getNbWrittenImages() const;
+    std::size_t getNbFailedImages() const;
+
+private:
+    struct Job
+    {
+        PixelFramePtr frame;
+        std::string fileName;
+        int compressionLevel { -1 };
+    };
+
+    void loop();
+    static bool write(const PixelFrame& frame, const std::string& fileName, int compressionLevel);
+
+    std::size_t m_nbThreads { 1 };
+    std::size_t m_capacity { 0 };
+    bool m_bLogEachImage { true };
+
+    std::vector<std::thread> m_threads;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_jobQueued;
+    std::condition_variable m_jobTaken;
+    std::deque<Job> m_queue;
+    std::size_t m_nbWriting { 0 };
+    std::size_t m_nbWritten { 0 };
+    std::size_t m_nbFailed { 0 };
+    bool m_stopRequested { false };
+};
+
+} // namespace sofaglfw
@@ -0,0 +1,300 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU General Public License as published by the Free  *
+* Software Foundation; either version 2 of the License, or (at your option)   *
+* any later version.                                                          *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for    *
+* more details.                                                               *
+*                                                                             *
+* You should have received a copy of the GNU General Public License along     *
+* with this program. If not, see <http://www.gnu.org/licenses/>.              *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <SofaGLFW/SharedMemoryFrameStream.h>
+
+#include <sofa/helper/logging/Messaging.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <new>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace sofaglfw
+{
+
+namespace
+{
+
+constexpr char streamMagic[8] = "SOFAFRM";
+constexpr std::uint32_t streamVersion = 1;
+constexpr std::size_t slotAlignment = 64;
+
+std::size_t alignSize(std::size_t size)
+{
+    return (size + slotAlignment - 1) / slotAlignment * slotAlignment;
+}
+
+SharedFrameSlotHeader* getSlot(std::uint8_t* memory, std::uint64_t frameId)
+{
+    const auto* header = reinterpret_cast<const SharedFrameStreamHeader*>(memory);
+    const std::size_t slotIndex = static_cast<std::size_t>((frameId - 1) % header->nbSlots);
+    return reinterpret_cast<SharedFrameSlotHeader*>(memory + sizeof(SharedFrameStreamHeader) + slotIndex * header->slotSize);
+}
+
+} // namespace
+
+bool SharedMemoryFramePublisher::open(const std::string& name, std::size_t nbSlots, std::size_t slotCapacity)
+{
+    close();
+
+    nbSlots = std::max<std::size_t>(2, nbSlots);
+    const std::size_t slotSize = sizeof(SharedFrameSlotHeader) + alignSize(slotCapacity);
+    const std::size_t memorySize = sizeof(SharedFrameStreamHeader) + nbSlots * slotSize;
+
+#if defined(_WIN32)
+    const std::string mappingName = (!name.empty() && name.front() == '/') ? name.substr(1) : name;
+    HANDLE mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+                                        static_cast<DWORD>(static_cast<std::uint64_t>(memorySize) >> 32), static_cast<DWORD>(memorySize & 0xFFFFFFFFu),
+                                        mappingName.c_str());
+    if (mapping == nullptr)
+    {
+        msg_error("SharedMemoryFramePublisher") << "Cannot create the shared memory " << name << " (error " << GetLastError() << ")";
+        return false;
+    }
+    void* memory = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, memorySize);
+    if (memory == nullptr)
+    {
+        msg_error("SharedMemoryFramePublisher") << "Cannot map the shared memory " << name << " (error " << GetLastError() << ")";
+        CloseHandle(mapping);
+        return false;
+    }
+    m_mapping = mapping;
+#else
+    // a stream left by a crashed process is replaced
+    shm_unlink(name.c_str());
+    const int descriptor = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (descriptor < 0)
+    {
+        msg_error("SharedMemoryFramePublisher") << "Cannot create the shared memory " << name << ": " << std::strerror(errno);
+        return false;
+    }
+    if (ftruncate(descriptor, static_cast<off_t>(memorySize)) != 0)
+    {
+        msg_error("SharedMemoryFramePublisher") << "Cannot allocate " << memorySize << " bytes of shared memory: " << std::strerror(errno);
+        ::close(descriptor);
+        shm_unlink(name.c_str());
+        return false;
+    }
+    void* memory = mmap(nullptr, memorySize, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+    ::close(descriptor);
+    if (memory == MAP_FAILED)
+    {
+        msg_error("SharedMemoryFramePublisher") << "Cannot map the shared memory " << name << ": " << std::strerror(errno);
+        shm_unlink(name.c_str());
+        return false;
+    }
+#endif
+
+    m_name = name;
+    m_memory = static_cast<std::uint8_t*>(memory);
+    m_memorySize = memorySize;
+    m_lastFrameId = 0;
+
+    // the mapping is zero-filled: the slots start with an even sequence and no frame
+    auto* header = new (m_memory) SharedFrameStreamHeader;
+    header->version = streamVersion;
+    header->nbSlots = static_cast<std::uint32_t>(nbSlots);
+    header->slotSize = slotSize;
+    header->slotCapacity = slotCapacity;
+    header->lastFrameId.store(0, std::memory_order_relaxed);
+    for (std::size_t i = 0; i < nbSlots; ++i)
+    {
+        new (m_memory + sizeof(SharedFrameStreamHeader) + i * slotSize) SharedFrameSlotHeader {};
+    }
+    // written last: the readers do not use a stream before its magic is set
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(header->magic, streamMagic, sizeof(streamMagic));
+
+    msg_info("SharedMemoryFramePublisher") << "Publishing frames into the shared memory " << name << " (" << nbSlots << " slots of " << slotCapacity << " bytes)";
+    return true;
+}
+
+bool SharedMemoryFramePublisher::publish(const PixelFrame& frame)
+{
+    auto* header = reinterpret_cast<SharedFrameStreamHeader*>(m_memory);
+    const std::size_t nbBytes = frame.getNbBytes();
+    if (!isOpen() || frame.data == nullptr || nbBytes > header->slotCapacity)
+    {
+        return false;
+    }
+
+    const std::uint64_t frameId = m_lastFrameId + 1;
+    SharedFrameSlotHeader* slot = getSlot(m_memory, frameId);
+
+    const std::uint64_t sequence = slot->sequence.load(std::memory_order_relaxed);
+    slot->sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot->frameId = frameId;
+    slot->simulationTime = frame.time;
+    slot->width = frame.size[0];
+    slot->height = frame.size[1];
+    slot->format = static_cast<std::uint32_t>(frame.format);
+    slot->nbBytes = nbBytes;
+    std::memcpy(reinterpret_cast<std::uint8_t*>(slot) + sizeof(SharedFrameSlotHeader), frame.data, nbBytes);
+
+    slot->sequence.store(sequence + 2, std::memory_order_release);
+    header->lastFrameId.store(frameId, std::memory_order_release);
+    m_lastFrameId = frameId;
+
+    return true;
+}
+
+void SharedMemoryFramePublisher::close()
+{
+    if (!isOpen())
+    {
+        return;
+    }
+
+#if defined(_WIN32)
+    UnmapViewOfFile(m_memory);
+    CloseHandle(static_cast<HANDLE>(m_mapping));
+#else
+    munmap(m_memory, m_memorySize);
+    shm_unlink(m_name.c_str());
+#endif
+
+    m_memory = nullptr;
+    m_mapping = nullptr;
+    m_memorySize = 0;
+}
+
+bool SharedMemoryFrameReader::open(const std::string& name)
+{
+    close();
+
+#if defined(_WIN32)
+    const std::string mappingName = (!name.empty() && name.front() == '/') ? name.substr(1) : name;
+    HANDLE mapping = OpenFileMappingA(FILE_MAP_READ, FALSE, mappingName.c_str());
+    if (mapping == nullptr)
+    {
+        msg_error("SharedMemoryFrameReader") << "Cannot open the shared memory " << name << " (error " << GetLastError() << ")";
+        return false;
+    }
+    void* memory = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    MEMORY_BASIC_INFORMATION info {};
+    if (memory == nullptr || VirtualQuery(memory, &info, sizeof(info)) == 0)
+    {
+        msg_error("SharedMemoryFrameReader") << "Cannot map the shared memory " << name << " (error " << GetLastError() << ")";
+        if (memory) UnmapViewOfFile(memory);
+        CloseHandle(mapping);
+        return false;
+    }
+    const std::size_t memorySize = info.RegionSize;
+    m_mapping = mapping;
+#else
+    const int descriptor = shm_open(name.c_str(), O_RDONLY, 0);
+    if (descriptor < 0)
+    {
+        msg_error("SharedMemoryFrameReader") << "Cannot open the shared memory " << name << ": " << std::strerror(errno);
+        return false;
+    }
+    struct stat status {};
+    fstat(descriptor, &status);
+    const std::size_t memorySize = static_cast<std::size_t>(status.st_size);
+    void* memory = (memorySize > 0) ? mmap(nullptr, memorySize, PROT_READ, MAP_SHARED, descriptor, 0) : MAP_FAILED;
+    ::close(descriptor);
+    if (memory == MAP_FAILED)
+    {
+        msg_error("SharedMemoryFrameReader") << "Cannot map the shared memory " << name << ": " << std::strerror(errno);
+        return false;
+    }
+#endif
+
+    m_memory = static_cast<const std::uint8_t*>(memory);
+    m_memorySize = memorySize;
+
+    const auto* header = reinterpret_cast<const SharedFrameStreamHeader*>(m_memory);
+    const bool isValid = memorySize >= sizeof(SharedFrameStreamHeader) && std::memcmp(header->magic, streamMagic, sizeof(streamMagic)) == 0
+                      && header->version == streamVersion && header->nbSlots > 0
+                      && sizeof(SharedFrameStreamHeader) + header->nbSlots * header->slotSize <= memorySize;
+    if (!isValid)
+    {
+        msg_error("SharedMemoryFrameReader") << "The shared memory " << name << " is not a frame stream (or not initialized yet)";
+        close();
+        return false;
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    return true;
+}
+
+std::uint64_t SharedMemoryFrameReader::getLastFrameId() const
+{
+    if (!isOpen())
+    {
+        return 0;
+    }
+    return reinterpret_cast<const SharedFrameStreamHeader*>(m_memory)->lastFrameId.load(std::memory_order_acquire);
+}
+
+bool SharedMemoryFrameReader::readFrame(std::uint64_t frameId, const FrameFunction& function) const
+{
+    if (!isOpen() || frameId == 0 || frameId > getLastFrameId())
+    {
+        return false;
+    }
+
+    // the mapping is read-only: the slot is only read, through the atomic loads
+    const SharedFrameSlotHeader* slot = getSlot(const_cast<std::uint8_t*>(m_memory), frameId);
+    const std::uint64_t sequence = slot->sequence.load(std::memory_order_acquire);
+    if ((sequence & 1) != 0 || slot->frameId != frameId)
+    {
+        return false;
+    }
+
+    function(*slot, reinterpret_cast<const std::uint8_t*>(slot) + sizeof(SharedFrameSlotHeader));
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return slot->sequence.load(std::memory_order_relaxed) == sequence;
+}
+
+void SharedMemoryFrameReader::close()
+{
+    if (!isOpen())
+    {
+        return;
+    }
+
+#if defined(_WIN32)
+    UnmapViewOfFile(m_memory);
+    CloseHandle(static_cast<HANDLE>(m_mapping));
+#else
+    munmap(const_cast<std::uint8_t*>(m_memory), m_memorySize);
+#endif
+
+    m_memory = nullptr;
+    m_mapping = nullptr;
+    m_memorySize = 0;
+}
+
+} // namespace sofaglfw
@@ -0,0 +1,140 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU General Public License as published by the Free  *
+* Software Foundation; either version 2 of the License, or (at your option)   *
+* any later version.                                                          *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for    *
+* more details.                                                               *
+*                                                                             *
+* You should have received a copy of the GNU General Public License along     *
+* with this program. If not, see <http://www.gnu.org/licenses/>.              *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#pragma once
+#include <SofaGLFW/config.h>
+#include <SofaGLFW/PixelReadbackRing.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+namespace sofaglfw
+{
+
+/**
+ * Layout of a shared-memory frame stream, for the readers written in other languages:
+ * a SharedFrameStreamHeader at offset 0, followed by nbSlots slots of slotSize bytes. Each slot starts with
+ * a SharedFrameSlotHeader, followed by the pixels. The frame of id n (ids start at 1) is in slot (n - 1) % nbSlots.
+ *
+ * The slots are protected by a sequence lock: the writer makes the sequence odd while it writes the slot, and
+ * even when the slot is complete. A reader reads the sequence (even), uses the frame in place, then reads the
+ * sequence again: if it changed, the slot was overwritten meanwhile and the frame must be dropped.
+ */
+struct alignas(64) SharedFrameStreamHeader
+{
+    char magic[8];                          ///< "SOFAFRM"
+    std::uint32_t version;
+    std::uint32_t nbSlots;
+    std::uint64_t slotSize;                 ///< bytes from a slot to the next one
+    std::uint64_t slotCapacity;             ///< maximum number of bytes of pixels in a slot
+    std::atomic<std::uint64_t> lastFrameId; ///< id of the last complete frame, 0 if none
+};
+
+struct alignas(64) SharedFrameSlotHeader
+{
+    std::atomic<std::uint64_t> sequence;    ///< odd while the slot is written
+    std::uint64_t frameId;
+    double simulationTime;                  ///< time of the simulation when the frame was drawn
+    std::int32_t width;
+    std::int32_t height;
+    std::uint32_t format;                   ///< PixelFormat: 0 for RGBA (rows from bottom to top), 1 for YUV420 (rows from top to bottom)
+    std::uint32_t reserved;
+    std::uint64_t nbBytes;                  ///< bytes of pixels, following the header
+};
+
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "the sequence lock is shared between processes");
+
+/**
+ * @brief Publishes frames into a shared-memory ring (POSIX shm_open, or a named file mapping on Windows),
+ * from which any number of local processes can read them without copy nor encoding.
+ *
+ * Frames are never waited for: a slow reader misses frames, and detects it with the frame ids.
+ * The shared memory is removed when the publisher is closed.
+ */
+class SOFAGLFW_API SharedMemoryFramePublisher
+{
+public:
+    SharedMemoryFramePublisher() = default;
+    ~SharedMemoryFramePublisher() { close(); }
+
+    SharedMemoryFramePublisher(const SharedMemoryFramePublisher&) = delete;
+    SharedMemoryFramePublisher& operator=(const SharedMemoryFramePublisher&) = delete;
+
+    /// Create the shared memory (e.g. "/sofaglfw_frames") with nbSlots slots (at least 2) of slotCapacity bytes of pixels.
+    bool open(const std::string& name, std::size_t nbSlots, std::size_t slotCapacity);
+    bool isOpen() const { return m_memory != nullptr; }
+    const std::string& getName() const { return m_name; }
+
+    /// Copy the frame into the next slot. Returns false if the frame does not fit in a slot.
+    bool publish(const PixelFrame& frame);
+
+    std::uint64_t getNbPublishedFrames() const { return m_lastFrameId; }
+
+    /// Remove the shared memory. The readers keep their mapping until they close it.
+    void close();
+
+private:
+    std::string m_name;
+    std::uint8_t* m_memory { nullptr };
+    std::size_t m_memorySize { 0 };
+    void* m_mapping { nullptr };  ///< handle of the file mapping on Windows
+    std::uint64_t m_lastFrameId { 0 };
+};
+
+/**
+ * @brief Reads the frames of a SharedMemoryFramePublisher, possibly from another process.
+ */
+class SOFAGLFW_API SharedMemoryFrameReader
+{
+public:
+    using FrameFunction = std::function<void(const SharedFrameSlotHeader& frame, const std::uint8_t* pixels)>;
+
+    SharedMemoryFrameReader() = default;
+    ~SharedMemoryFrameReader() { close(); }
+
+    SharedMemoryFrameReader(const SharedMemoryFrameReader&) = delete;
+    SharedMemoryFrameReader& operator=(const SharedMemoryFrameReader&) = delete;
+
+    bool open(const std::string& name);
+    bool isOpen() const { return m_memory != nullptr; }
+
+    /// Id of the last frame published, 0 if none.
+    std::uint64_t getLastFrameId() const;
+
+    /**
+     * Call function on the frame of the given id, in place. Returns false if the frame is not available (not
+     * published yet, or overwritten before or while function was called): the pixels seen by function must
+     * then be ignored. The frame may be overwritten meanwhile if function takes longer than nbSlots - 1 frames.
+     */
+    bool readFrame(std::uint64_t frameId, const FrameFunction& function) const;
+
+    void close();
+
+private:
+    const std::uint8_t* m_memory { nullptr };
+    std::size_t m_memorySize { 0 };
+    void* m_mapping { nullptr };
+};
+
+} // namespace sofaglfw
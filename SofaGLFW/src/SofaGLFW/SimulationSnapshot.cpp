@@ -0,0 +1,168 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU General Public License as published by the Free  *
+* Software Foundation; either version 2 of the License, or (at your option)   *
+* any later version.                                                          *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for    *
+* more details.                                                               *
+*                                                                             *
+* You should have received a copy of the GNU General Public License along     *
+* with this program. If not, see <http://www.gnu.org/licenses/>.              *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <SofaGLFW/SimulationSnapshot.h>
+
+#include <sofa/core/objectmodel/BaseData.h>
+#include <sofa/defaulttype/AbstractTypeInfo.h>
+#include <sofa/helper/logging/Messaging.h>
+#include <sofa/simulation/Node.h>
+
+#include <cstring>
+
+namespace sofaglfw
+{
+
+namespace
+{
+
+bool isStored(const sofa::core::objectmodel::BaseData* data)
+{
+    // linked and output Data are recomputed from the others
+    if (data->getParent() != nullptr || data->isReadOnly())
+    {
+        return false;
+    }
+
+    // resetting the simulation does not change whether it is running
+    return data->getName() != "animate";
+}
+
+} // namespace
+
+void SimulationSnapshot::clear()
+{
+    m_root = nullptr;
+    m_states.clear();
+    m_memorySize = 0;
+}
+
+void SimulationSnapshot::capture(sofa::simulation::Node* root)
+{
+    clear();
+    if (!root)
+    {
+        return;
+    }
+
+    m_root = root;
+
+    std::vector<sofa::simulation::Node*> nodes { root };
+    while (!nodes.empty())
+    {
+        auto* node = nodes.back();
+        nodes.pop_back();
+
+        captureObject(node);
+        for (const auto& object : node->object)
+        {
+            captureObject(object.get());
+        }
+        for (const auto& child : node->child)
+        {
+            nodes.push_back(child.get());
+        }
+    }
+
+    msg_info("SimulationSnapshot") << "Captured the state of " << m_states.size() << " nodes and components ("
+                                   << m_memorySize / 1024 << " KiB)";
+}
+
+void SimulationSnapshot::captureObject(sofa::core::objectmodel::Base* object)
+{
+    ObjectState state;
+    state.object = object;
+
+    for (auto* data : object->getDataFields())
+    {
+        if (!isStored(data))
+        {
+            continue;
+        }
+
+        DataValue value;
+        value.data = data;
+
+        const auto* typeInfo = data->getValueTypeInfo();
+        if (typeInfo && typeInfo->ValidInfo() && typeInfo->SimpleLayout())
+        {
+            const void* valuePtr = data->getValueVoidPtr();
+            value.isRaw = true;
+            value.nbItems = typeInfo->size(valuePtr);
+            const std::size_t nbBytes = value.nbItems * typeInfo->byteSize();
+            value.bytes.resize(nbBytes);
+            if (nbBytes > 0)
+            {
+                std::memcpy(value.bytes.data(), typeInfo->getValuePtr(valuePtr), nbBytes);
+            }
+            m_memorySize += nbBytes;
+        }
+        else
+        {
+            value.text = data->getValueString();
+            m_memorySize += value.text.size();
+        }
+
+        state.values.push_back(std::move(value));
+    }
+
+    m_states.push_back(std::move(state));
+}
+
+bool SimulationSnapshot::restore(sofa::simulation::Node* root) const
+{
+    if (!isCapturedFrom(root))
+    {
+        return false;
+    }
+
+    for (const auto& state : m_states)
+    {
+        for (const auto& value : state.values)
+        {
+            auto* data = value.data;
+            if (value.isRaw)
+            {
+                const auto* typeInfo = data->getValueTypeInfo();
+                void* valuePtr = data->beginEditVoidPtr();
+                if (typeInfo->size(valuePtr) != value.nbItems)
+                {
+                    typeInfo->setSize(valuePtr, value.nbItems);
+                }
+                if (!value.bytes.empty())
+                {
+                    std::memcpy(typeInfo->getValuePtr(valuePtr), value.bytes.data(), value.bytes.size());
+                }
+                data->endEditVoidPtr();
+            }
+            else if (data->getValueString() != value.text)
+            {
+                data->read(value.text);
+            }
+        }
+    }
+
+    // let the components reset their internal state, and update the mappings and the visual models
+    sofa::simulation::node::reset(root);
+    return true;
+}
+
+} // namespace sofaglfw
@@ -0,0 +1,80 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU General Public License as published by the Free  *
+* Software Foundation; either version 2 of the License, or (at your option)   *
+* any later version.                                                          *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for    *
+* more details.                                                               *
+*                                                                             *
+* You should have received a copy of the GNU General Public License along     *
+* with this program. If not, see <http://www.gnu.org/licenses/>.              *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#pragma once
+#include <SofaGLFW/config.h>
+
+#include <sofa/core/objectmodel/Base.h>
+#include <sofa/simulation/Node.h>
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace sofaglfw
+{
+
+/**
+ * @brief In-memory copy of the Data values of a scene graph, to restore its state without reloading the file.
+ *
+ * Data with a simple memory layout (scalars, vectors of Vec, ...) are copied as raw bytes, the others as strings.
+ * Data linked to a parent and read-only Data (e.g. engine outputs) are not stored: they are recomputed.
+ * Components added to the graph after the capture are left untouched by restore().
+ */
+class SOFAGLFW_API SimulationSnapshot
+{
+public:
+    /// Store the Data values of all the nodes and components of the graph.
+    void capture(sofa::simulation::Node* root);
+
+    /// Copy the stored values back into the graph, then reset it (time, mappings, visual models).
+    bool restore(sofa::simulation::Node* root) const;
+
+    void clear();
+    bool isCapturedFrom(const sofa::simulation::Node* root) const { return root != nullptr && m_root == root; }
+
+    /// Memory used by the stored values, in bytes.
+    std::size_t getMemorySize() const { return m_memorySize; }
+
+private:
+    struct DataValue
+    {
+        sofa::core::objectmodel::BaseData* data { nullptr };
+        bool isRaw { false };
+        std::size_t nbItems { 0 };      ///< number of scalar items, for the raw copies
+        std::vector<std::byte> bytes;   ///< raw copy if the type has a simple layout
+        std::string text;               ///< serialized value otherwise
+    };
+
+    struct ObjectState
+    {
+        sofa::core::objectmodel::Base::SPtr object; ///< keeps the owner of the Data alive
+        std::vector<DataValue> values;
+    };
+
+    void captureObject(sofa::core::objectmodel::Base* object);
+
+    const sofa::simulation::Node* m_root { nullptr };
+    std::vector<ObjectState> m_states;
+    std::size_t m_memorySize { 0 };
+};
+
+} // namespace sofaglfw
@@ -0,0 +1,177 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU General Public License as published by the Free  *
+* Software Foundation; either version 2 of the License, or (at your option)   *
+* any later version.                                                          *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for    *
+* more details.                                                               *
+*                                                                             *
+* You should have received a copy of the GNU General Public License along     *
+* with this program. If not, see <http://www.gnu.org/licenses/>.              *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <SofaGLFW/SimulationThread.h>
+
+#include <chrono>
+#include <cmath>
+#include <limits>
+
+namespace sofaglfw
+{
+
+SimulationThread::~SimulationThread()
+{
+    stop();
+}
+
+void SimulationThread::start(StepFunction stepFunction, std::size_t maxNbSteps, IdleTimeFunction idleTimeFunction)
+{
+    if (isRunning())
+        return;
+
+    m_stepFunction = std::move(stepFunction);
+    m_idleTimeFunction = std::move(idleTimeFunction);
+    m_maxNbSteps = maxNbSteps;
+    m_nbSteps = 0;
+    m_stopRequested = false;
+    m_drawRequested = false;
+    m_hasNewStep = false;
+    m_stateChanged = false;
+
+    m_thread = std::thread(&SimulationThread::loop, this);
+}
+
+void SimulationThread::stop()
+{
+    if (!isRunning())
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(m_handoffMutex);
+        m_stopRequested = true;
+    }
+    m_handoffCondition.notify_all();
+
+    m_thread.join();
+}
+
+void SimulationThread::notifyStateChanged()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_handoffMutex);
+        m_stateChanged = true;
+    }
+    m_handoffCondition.notify_all();
+}
+
+SimulationThread::SceneLock SimulationThread::tryAcquireScene()
+{
+    // requested before trying, so that a worker holding the scene sees the request when releasing it
+    m_drawRequested = true;
+    SceneLock lock(m_sceneMutex, std::try_to_lock);
+    if (lock.owns_lock())
+    {
+        {
+            std::lock_guard<std::mutex> handoffLock(m_handoffMutex);
+            m_drawRequested = false;
+        }
+        m_handoffCondition.notify_all();
+    }
+    return lock;
+}
+
+SimulationThread::SceneLock SimulationThread::acquireScene()
+{
+    ++m_nbSceneRequests;
+    SceneLock lock(m_sceneMutex);
+    {
+        std::lock_guard<std::mutex> handoffLock(m_handoffMutex);
+        --m_nbSceneRequests;
+        m_drawRequested = false;
+    }
+    m_handoffCondition.notify_all();
+    return lock;
+}
+
+void SimulationThread::loop()
+{
+    // the render thread is not expected to keep the scene longer than a frame:
+    // this timeout only avoids a deadlock if it stops drawing while a draw was requested
+    constexpr auto maxHandoffWait = std::chrono::milliseconds(100);
+
+    while (!m_stopRequested)
+    {
+        {
+            std::unique_lock<std::mutex> handoffLock(m_handoffMutex);
+            const bool handedOver = m_handoffCondition.wait_for(handoffLock, maxHandoffWait, [this]
+            {
+                return m_stopRequested || (m_nbSceneRequests == 0 && !m_drawRequested);
+            });
+            if (!handedOver)
+            {
+                m_drawRequested = false;
+            }
+        }
+
+        if (m_stopRequested)
+            break;
+
+        bool hasStepped = false;
+        double idleTime = std::numeric_limits<double>::infinity();
+        {
+            SceneLock sceneLock(m_sceneMutex);
+
+            // a change notified from now on is seen by the step function, or wakes up the idle wait below
+            m_stateChanged = false;
+
+            const std::size_t maxNbSteps = (m_maxNbSteps > 0) ? m_maxNbSteps - m_nbSteps : 0;
+            const auto stepStart = std::chrono::steady_clock::now();
+            const std::size_t nbSteps = m_stepFunction(maxNbSteps);
+            hasStepped = nbSteps > 0;
+            if (hasStepped)
+            {
+                m_lastStepDuration = std::chrono::duration<double>(std::chrono::steady_clock::now() - stepStart).count() / static_cast<double>(nbSteps);
+                m_nbSteps += nbSteps;
+                m_hasNewStep = true;
+            }
+            else if (m_idleTimeFunction)
+            {
+                idleTime = m_idleTimeFunction();
+            }
+        }
+
+        if (m_drawRequested && m_handOverCallback)
+        {
+            m_handOverCallback();
+        }
+
+        if (hasReachedMaxNbSteps())
+            break;
+
+        if (!hasStepped)
+        {
+            // nothing to compute: sleep until the next scheduled step, or until something changes
+            std::unique_lock<std::mutex> handoffLock(m_handoffMutex);
+            const auto isWokenUp = [this] { return m_stopRequested || m_stateChanged; };
+            if (std::isinf(idleTime))
+            {
+                m_handoffCondition.wait(handoffLock, isWokenUp);
+            }
+            else if (idleTime > 0.0)
+            {
+                m_handoffCondition.wait_for(handoffLock, std::chrono::duration<double>(idleTime), isWokenUp);
+            }
+        }
+    }
+}
+
+} // namespace sofaglfw
@@ -0,0 +1,118 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU General Public License as published by the Free  *
+* Software Foundation; either version 2 of the License, or (at your option)   *
+* any later version.                                                          *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for    *
+* more details.                                                               *
+*                                                                             *
+* You should have received a copy of the GNU General Public License along     *
+* with this program. If not, see <http://www.gnu.org/licenses/>.              *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#pragma once
+#include <SofaGLFW/config.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace sofaglfw
+{
+
+/**
+ * @brief Runs the simulation steps on a dedicated thread, decoupled from the rendering.
+ *
+ * The scene graph is shared between the worker and the render thread through a single lock:
+ * the worker holds it while computing a step (animate + updateVisual), the render thread holds it
+ * while drawing the scene. The visual models are only written by a complete step, so what is drawn
+ * is always the latest complete step.
+ *
+ * When the render thread fails to take the scene because a step is in progress, the worker hands it
+ * over at the end of this step. A draw therefore never waits for more than one step, and a step never
+ * waits for more than one draw.
+ */
+class SOFAGLFW_API SimulationThread
+{
+public:
+    using SceneMutex = std::recursive_mutex;
+    using SceneLock = std::unique_lock<SceneMutex>;
+
+    /// Computes at most maxNbSteps steps (no limit if 0) and returns the number of steps computed,
+    /// 0 if there was nothing to compute (e.g. the simulation is paused).
+    using StepFunction = std::function<std::size_t(std::size_t maxNbSteps)>;
+
+    /// Called with the scene taken when the step function computed nothing: returns how long (in seconds) the worker
+    /// can sleep before calling it again, or infinity to sleep until notifyStateChanged() (e.g. the simulation is paused).
+    using IdleTimeFunction = std::function<double()>;
+
+    SimulationThread() = default;
+    ~SimulationThread();
+
+    SimulationThread(const SimulationThread&) = delete;
+    SimulationThread& operator=(const SimulationThread&) = delete;
+
+    /// Start the worker. If maxNbSteps is not 0, the worker stops by itself after this number of steps.
+    /// Without idleTimeFunction, the worker sleeps until notifyStateChanged() when there was nothing to compute.
+    void start(StepFunction stepFunction, std::size_t maxNbSteps = 0, IdleTimeFunction idleTimeFunction = {});
+    void stop();
+
+    /// Wakes the worker up if it is sleeping because there was nothing to compute,
+    /// to be called when something may have given it steps to compute (play, stepping command, settings...)
+    void notifyStateChanged();
+    bool isRunning() const { return m_thread.joinable(); }
+
+    /// Take the scene without waiting. If a step is in progress, the returned lock does not own the scene
+    /// and the worker will hand it over at the end of the step.
+    SceneLock tryAcquireScene();
+
+    /// Called by the worker when it releases the scene while a tryAcquireScene() failed, e.g. to wake the render thread up
+    void setHandOverCallback(std::function<void()> callback) { m_handOverCallback = std::move(callback); }
+
+    /// Take the scene, waiting at most for the end of the step in progress.
+    SceneLock acquireScene();
+
+    /// Returns true if a step has been completed since the last call.
+    bool consumeNewStep() { return m_hasNewStep.exchange(false); }
+
+    std::size_t getNbSteps() const { return m_nbSteps; }
+    bool hasReachedMaxNbSteps() const { return m_maxNbSteps > 0 && m_nbSteps >= m_maxNbSteps; }
+
+    /// Wall-clock duration of the last step, in seconds
+    double getLastStepDuration() const { return m_lastStepDuration; }
+
+private:
+    void loop();
+
+    std::thread m_thread;
+    SceneMutex m_sceneMutex;
+
+    std::mutex m_handoffMutex;
+    std::condition_variable m_handoffCondition;
+    std::atomic<int> m_nbSceneRequests{ 0 };
+    std::atomic<bool> m_drawRequested{ false };
+
+    std::atomic<bool> m_stopRequested{ false };
+    std::atomic<bool> m_stateChanged{ false };
+    std::atomic<bool> m_hasNewStep{ false };
+    std::atomic<std::size_t> m_nbSteps{ 0 };
+    std::atomic<double> m_lastStepDuration{ 0.0 };
+    std::size_t m_maxNbSteps{ 0 };
+    StepFunction m_stepFunction;
+    IdleTimeFunction m_idleTimeFunction;
+    std::function<void()> m_handOverCallback;
+};
+
+} // namespace sofaglfw
@@ -0,0 +1,365 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU General Public License as published by the Free  *
+* Software Foundation; either version 2 of the License, or (at your option)   *
+* any later version.                                                          *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for    *
+* more details.                                                               *
+*                                                                             *
+* You should have received a copy of the GNU General Public License along     *
+* with this program. If not, see <http://www.gnu.org/licenses/>.              *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <SofaGLFW/SimulationTimeline.h>
+
+#include <sofa/core/ExecParams.h>
+#include <sofa/core/VecId.h>
+#include <sofa/simulation/UpdateMappingVisitor.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace sofaglfw
+{
+
+namespace
+{
+
+void writeVarint(std::vector<std::uint8_t>& bytes, std::size_t value)
+{
+    while (value >= 0x80)
+    {
+        bytes.push_back(static_cast<std::uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    bytes.push_back(static_cast<std::uint8_t>(value));
+}
+
+std::size_t readVarint(const std::vector<std::uint8_t>& bytes, std::size_t& pos)
+{
+    std::size_t value = 0;
+    for (unsigned int shift = 0; pos < bytes.size(); shift += 7)
+    {
+        const std::uint8_t byte = bytes[pos++];
+        value |= static_cast<std::size_t>(byte & 0x7f) << shift;
+        if (!(byte & 0x80))
+        {
+            break;
+        }
+    }
+    return value;
+}
+
+/// Number of bytes without the leading zero bytes (1 to 8 for a non-zero word)
+unsigned int getNbSignificantBytes(std::uint64_t word)
+{
+    unsigned int nbBytes = 1;
+    while (nbBytes < 8 && (word >> (8 * nbBytes)) != 0)
+    {
+        ++nbBytes;
+    }
+    return nbBytes;
+}
+
+/**
+ * Run-length encoding of cur XOR ref, as runs of: number of equal words (varint), number of different words (varint),
+ * number of significant bytes of each XORed word (a nibble each), significant bytes of each XORed word.
+ * A DOF which moved a little keeps its sign, exponent and first bits of mantissa: its XOR has leading zero bytes.
+ */
+void encodeDelta(const std::vector<std::uint64_t>& cur, const std::vector<std::uint64_t>& ref, std::vector<std::uint8_t>& encoded)
+{
+    encoded.clear();
+    const std::size_t n = cur.size();
+    std::size_t i = 0;
+    while (i < n)
+    {
+        const std::size_t zerosStart = i;
+        while (i < n && cur[i] == ref[i])
+        {
+            ++i;
+        }
+        const std::size_t literalsStart = i;
+        while (i < n && cur[i] != ref[i])
+        {
+            ++i;
+        }
+        if (literalsStart == i)
+        {
+            break; // only unchanged words until the end
+        }
+
+        const std::size_t nbLiterals = i - literalsStart;
+        writeVarint(encoded, literalsStart - zerosStart);
+        writeVarint(encoded, nbLiterals);
+
+        const std::size_t sizesPos = encoded.size();
+        encoded.resize(sizesPos + (nbLiterals + 1) / 2, 0);
+        for (std::size_t j = 0; j < nbLiterals; ++j)
+        {
+            const std::uint64_t word = cur[literalsStart + j] ^ ref[literalsStart + j];
+            const unsigned int nbBytes = getNbSignificantBytes(word);
+            encoded[sizesPos + j / 2] |= static_cast<std::uint8_t>((nbBytes - 1) << (4 * (j % 2)));
+            for (unsigned int b = 0; b < nbBytes; ++b)
+            {
+                encoded.push_back(static_cast<std::uint8_t>(word >> (8 * b)));
+            }
+        }
+    }
+    encoded.shrink_to_fit();
+}
+
+void applyDelta(const std::vector<std::uint8_t>& encoded, std::vector<std::uint64_t>& values)
+{
+    std::size_t index = 0;
+    std::size_t pos = 0;
+    while (pos < encoded.size())
+    {
+        index += readVarint(encoded, pos);
+        const std::size_t nbLiterals = readVarint(encoded, pos);
+
+        const std::size_t sizesPos = pos;
+        pos += (nbLiterals + 1) / 2;
+        for (std::size_t j = 0; j < nbLiterals; ++j)
+        {
+            const unsigned int nbBytes = ((encoded[sizesPos + j / 2] >> (4 * (j % 2))) & 0x7) + 1;
+            std::uint64_t word = 0;
+            for (unsigned int b = 0; b < nbBytes; ++b)
+            {
+                word |= static_cast<std::uint64_t>(encoded[pos++]) << (8 * b);
+            }
+            values[index++] ^= word;
+        }
+    }
+}
+
+} // namespace
+
+void SimulationTimeline::setMemoryBudget(std::size_t nbBytes)
+{
+    m_memoryBudget = nbBytes;
+    if (!isEnabled())
+    {
+        clear();
+    }
+    else
+    {
+        dropOldestFrames();
+    }
+}
+
+void SimulationTimeline::clear()
+{
+    m_root = nullptr;
+    m_states.clear();
+    m_stateSizes.clear();
+    m_frames.clear();
+    m_currentFrame = 0;
+    m_nbFramesSinceKeyframe = 0;
+    m_lastValues.clear();
+    m_memorySize = 0;
+}
+
+bool SimulationTimeline::updateStates(sofa::simulation::Node* root)
+{
+    if (root != m_root)
+    {
+        clear();
+        m_root = root;
+        std::vector<sofa::core::behavior::BaseMechanicalState*> states;
+        root->getTreeObjects<sofa::core::behavior::BaseMechanicalState>(&states);
+        for (auto* state : states)
+        {
+            m_states.emplace_back(state);
+        }
+    }
+
+    bool hasChanged = m_stateSizes.size() != m_states.size();
+    m_stateSizes.resize(m_states.size());
+    for (std::size_t i = 0; i < m_states.size(); ++i)
+    {
+        const auto& state = m_states[i];
+        const std::size_t size = state->getSize() * (state->getCoordDimension() + state->getDerivDimension());
+        hasChanged = hasChanged || size != m_stateSizes[i];
+        m_stateSizes[i] = size;
+    }
+    return hasChanged;
+}
+
+void SimulationTimeline::readValues(std::vector<std::uint64_t>& values) const
+{
+    std::size_t totalSize = 0;
+    for (const auto size : m_stateSizes)
+    {
+        totalSize += size;
+    }
+    values.resize(totalSize);
+
+    std::vector<SReal> buffer;
+    std::size_t offset = 0;
+    for (std::size_t i = 0; i < m_states.size(); ++i)
+    {
+        buffer.resize(m_stateSizes[i]);
+        const auto& state = m_states[i];
+        const std::size_t nbPositions = state->getSize() * state->getCoordDimension();
+        state->copyToBuffer(buffer.data(), sofa::core::ConstVecCoordId::position(), static_cast<unsigned int>(nbPositions));
+        state->copyToBuffer(buffer.data() + nbPositions, sofa::core::ConstVecDerivId::velocity(), static_cast<unsigned int>(m_stateSizes[i] - nbPositions));
+
+        // bit patterns, so that the deltas are exact
+        for (std::size_t j = 0; j < buffer.size(); ++j)
+        {
+            const double value = static_cast<double>(buffer[j]);
+            std::memcpy(&values[offset + j], &value, sizeof(double));
+        }
+        offset += m_stateSizes[i];
+    }
+}
+
+void SimulationTimeline::writeValues(const std::vector<std::uint64_t>& values) const
+{
+    std::vector<SReal> buffer;
+    std::size_t offset = 0;
+    for (std::size_t i = 0; i < m_states.size(); ++i)
+    {
+        buffer.resize(m_stateSizes[i]);
+        for (std::size_t j = 0; j < buffer.size(); ++j)
+        {
+            double value;
+            std::memcpy(&value, &values[offset + j], sizeof(double));
+            buffer[j] = static_cast<SReal>(value);
+        }
+
+        const auto& state = m_states[i];
+        const std::size_t nbPositions = state->getSize() * state->getCoordDimension();
+        state->copyFromBuffer(sofa::core::VecCoordId::position(), buffer.data(), static_cast<unsigned int>(nbPositions));
+        state->copyFromBuffer(sofa::core::VecDerivId::velocity(), buffer.data() + nbPositions, static_cast<unsigned int>(m_stateSizes[i] - nbPositions));
+        offset += m_stateSizes[i];
+    }
+}
+
+void SimulationTimeline::record(sofa::simulation::Node* root)
+{
+    if (!isEnabled() || !root)
+    {
+        return;
+    }
+
+    // the simulation went on from a past frame: the following frames are not its future anymore
+    while (!m_frames.empty() && m_frames.size() > m_currentFrame + 1)
+    {
+        m_memorySize -= m_frames.back().getMemorySize();
+        m_frames.pop_back();
+    }
+
+    const bool layoutHasChanged = updateStates(root);
+    if (layoutHasChanged && !m_frames.empty())
+    {
+        // the frames cannot be applied to the new topology
+        clear();
+        updateStates(root);
+    }
+
+    std::vector<std::uint64_t> values;
+    readValues(values);
+
+    Frame frame;
+    frame.time = root->getTime();
+    frame.isKeyframe = m_frames.empty() || m_nbFramesSinceKeyframe + 1 >= m_keyframeInterval;
+    if (frame.isKeyframe)
+    {
+        frame.values = values;
+        m_nbFramesSinceKeyframe = 0;
+    }
+    else
+    {
+        encodeDelta(values, m_lastValues, frame.delta);
+        ++m_nbFramesSinceKeyframe;
+    }
+
+    m_memorySize += frame.getMemorySize();
+    m_frames.push_back(std::move(frame));
+    m_lastValues = std::move(values);
+
+    dropOldestFrames();
+    m_currentFrame = m_frames.empty() ? 0 : m_frames.size() - 1;
+}
+
+void SimulationTimeline::dropOldestFrames()
+{
+    // frames are dropped by whole groups (a keyframe and its deltas)
+    while (m_memorySize > m_memoryBudget && m_frames.size() > 1)
+    {
+        const auto nextKeyframe = std::find_if(m_frames.begin() + 1, m_frames.end(), [](const Frame& frame) { return frame.isKeyframe; });
+        if (nextKeyframe == m_frames.end())
+        {
+            // the group being written is the only one: its oldest frame is dropped, the next one becomes its keyframe
+            if (m_currentFrame == 0)
+            {
+                break;
+            }
+            m_memorySize -= m_frames[0].getMemorySize() + m_frames[1].getMemorySize();
+            std::vector<std::uint64_t> values = std::move(m_frames[0].values);
+            applyDelta(m_frames[1].delta, values);
+            m_frames.pop_front();
+            m_frames.front().isKeyframe = true;
+            m_frames.front().values = std::move(values);
+            m_frames.front().delta = {};
+            m_memorySize += m_frames.front().getMemorySize();
+
+            --m_currentFrame;
+            m_nbFramesSinceKeyframe -= std::min<std::size_t>(m_nbFramesSinceKeyframe, 1);
+            continue;
+        }
+
+        const auto nbDroppedFrames = static_cast<std::size_t>(std::distance(m_frames.begin(), nextKeyframe));
+        for (std::size_t i = 0; i < nbDroppedFrames; ++i)
+        {
+            m_memorySize -= m_frames.front().getMemorySize();
+            m_frames.pop_front();
+        }
+        m_currentFrame -= std::min(m_currentFrame, nbDroppedFrames);
+    }
+}
+
+bool SimulationTimeline::restore(sofa::simulation::Node* root, std::size_t frameIndex)
+{
+    if (root != m_root || frameIndex >= m_frames.size() || updateStates(root))
+    {
+        return false;
+    }
+
+    std::size_t keyframeIndex = frameIndex;
+    while (!m_frames[keyframeIndex].isKeyframe)
+    {
+        --keyframeIndex;
+    }
+
+    std::vector<std::uint64_t> values = m_frames[keyframeIndex].values;
+    for (std::size_t i = keyframeIndex + 1; i <= frameIndex; ++i)
+    {
+        applyDelta(m_frames[i].delta, values);
+    }
+
+    writeValues(values);
+    root->setTime(m_frames[frameIndex].time);
+
+    // propagate to the mapped models
+    sofa::simulation::UpdateMappingVisitor updateMapping(sofa::core::execparams::defaultInstance());
+    root->execute(updateMapping);
+    sofa::simulation::node::updateVisual(root);
+
+    m_currentFrame = frameIndex;
+    m_nbFramesSinceKeyframe = frameIndex - keyframeIndex;
+    m_lastValues = std::move(values);
+    return true;
+}
+
+} // namespace sofaglfw
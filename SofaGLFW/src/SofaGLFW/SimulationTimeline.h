@@ -0,0 +1,103 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU General Public License as published by the Free  *
+* Software Foundation; either version 2 of the License, or (at your option)   *
+* any later version.                                                          *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for    *
+* more details.                                                               *
+*                                                                             *
+* You should have received a copy of the GNU General Public License along     *
+* with this program. If not, see <http://www.gnu.org/licenses/>.              *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#pragma once
+#include <SofaGLFW/config.h>
+
+#include <sofa/core/behavior/BaseMechanicalState.h>
+#include <sofa/simulation/Node.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+namespace sofaglfw
+{
+
+/**
+ * @brief Bounded history of the mechanical states (positions and velocities) of the last simulation steps.
+ *
+ * Every keyframe interval, a frame stores the full state (keyframe). The other frames only store the
+ * difference with the previous frame: XOR of the bit patterns, run-length encoded so that the DOFs which
+ * did not move cost nothing, and without their leading zero bytes so that the DOFs which moved a little cost
+ * less than a full value. When the memory budget is exceeded, the oldest keyframe and its deltas are dropped.
+ * If the group being written is the only one, its oldest frames are dropped one by one, the next frame
+ * becoming the keyframe.
+ */
+class SOFAGLFW_API SimulationTimeline
+{
+public:
+    /// Maximum memory used by the frames, in bytes. 0 disables the recording.
+    void setMemoryBudget(std::size_t nbBytes);
+    std::size_t getMemoryBudget() const { return m_memoryBudget; }
+    bool isEnabled() const { return m_memoryBudget > 0; }
+
+    void setKeyframeInterval(std::size_t nbFrames) { m_keyframeInterval = nbFrames > 0 ? nbFrames : 1; }
+    std::size_t getKeyframeInterval() const { return m_keyframeInterval; }
+
+    void clear();
+
+    /// Append the current state of the graph. The frames after the current one (if a past frame was restored) are discarded.
+    void record(sofa::simulation::Node* root);
+
+    /// Put the graph back in the state of the given frame, and make it the current one.
+    bool restore(sofa::simulation::Node* root, std::size_t frameIndex);
+
+    std::size_t getNbFrames() const { return m_frames.size(); }
+    std::size_t getCurrentFrame() const { return m_currentFrame; }
+    double getFrameTime(std::size_t frameIndex) const { return m_frames[frameIndex].time; }
+
+    /// Memory used by the frames, in bytes.
+    std::size_t getMemorySize() const { return m_memorySize; }
+
+private:
+    struct Frame
+    {
+        double time { 0.0 };
+        bool isKeyframe { false };
+        std::vector<std::uint64_t> values; ///< raw values of a keyframe
+        std::vector<std::uint8_t> delta; ///< encoded XOR delta with the previous frame otherwise
+
+        std::size_t getMemorySize() const { return sizeof(Frame) + values.capacity() * sizeof(std::uint64_t) + delta.capacity(); }
+    };
+
+    /// Collect the mechanical states of the graph. Returns true if the layout of the values changed.
+    bool updateStates(sofa::simulation::Node* root);
+    void readValues(std::vector<std::uint64_t>& values) const;
+    void writeValues(const std::vector<std::uint64_t>& values) const;
+    void dropOldestFrames();
+
+    std::size_t m_memoryBudget { 0 };
+    std::size_t m_keyframeInterval { 30 };
+
+    const sofa::simulation::Node* m_root { nullptr };
+    std::vector<sofa::core::behavior::BaseMechanicalState::SPtr> m_states;
+    std::vector<std::size_t> m_stateSizes; ///< number of scalars (positions then velocities) of each state
+
+    std::deque<Frame> m_frames;
+    std::size_t m_currentFrame { 0 };
+    std::size_t m_nbFramesSinceKeyframe { 0 };
+    std::vector<std::uint64_t> m_lastValues; ///< values of the current frame, reference of the next delta
+    std::size_t m_memorySize { 0 };
+};
+
+} // namespace sofaglfw
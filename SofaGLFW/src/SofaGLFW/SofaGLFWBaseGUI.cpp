@@ -28,6 +28,9 @@
 #include <SofaGLFW/config.h>
 
 #include <SofaGLFW/SofaGLFWMouseManager.h>
+#include <SofaGLFW/YUV420Converter.h>
+#include <SofaGLFW/ViewerUniformBuffer.h>
+#include <SofaGLFW/QOIImage.h>
 
 #include <sofa/helper/logging/Messaging.h>
 #include <sofa/helper/AdvancedTimer.h>
@@ -51,8 +54,17 @@
 #include <sofa/helper/Utils.h>
 
 #include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstring>
 #include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <limits>
 #include <map>
+#include <sstream>
+#include <thread>
 
 using namespace sofa;
 using namespace sofa::gui::common;
@@ -77,6 +89,15 @@ SofaGLFWBaseGUI::SofaGLFWBaseGUI()
 
 SofaGLFWBaseGUI::~SofaGLFWBaseGUI()
 {
+    // a scene still being loaded will never be displayed
+    if (m_sceneLoader.isBusy())
+    {
+        if (const auto result = m_sceneLoader.take(); result.root)
+        {
+            sofa::simulation::node::unload(result.root);
+        }
+    }
+
     terminate();
 }
 
@@ -148,9 +169,106 @@ void SofaGLFWBaseGUI::setSimulationIsRunning(bool running)
     if (this->groot)
     {
         this->groot->setAnimate(running);
+        m_simulationThread.notifyStateChanged();
+    }
+}
+
+
+bool SofaGLFWBaseGUI::loadSceneAsync(const std::string& fileName, bool reload)
+{
+    if (m_sceneLoader.isBusy())
+    {
+        msg_warning("SofaGLFWBaseGUI") << "A scene is already being loaded, ignoring " << fileName;
+        return false;
     }
+
+    {
+        // the current scene is only displayed while the new one is loaded
+        const auto sceneLock = acquireScene();
+        setSimulationIsRunning(false);
+        m_steppingController.cancel();
+    }
+
+    msg_info("SofaGLFWBaseGUI") << "Loading " << fileName;
+    return m_sceneLoader.start(fileName, reload, [this]() { redraw(); });
 }
 
+void SofaGLFWBaseGUI::finishSceneLoading()
+{
+    const double loadingTime = m_sceneLoader.getElapsedTime();
+    auto [newRoot, fileName, reload] = m_sceneLoader.take();
+    if (!newRoot)
+    {
+        newRoot = sofa::simulation::getSimulation()->createNewGraph("");
+        sofa::simulation::node::initRoot(newRoot.get());
+    }
+
+    NodeSPtr oldRoot;
+    {
+        const auto sceneLock = acquireScene();
+        oldRoot = this->groot;
+        setSimulation(newRoot, fileName);
+        m_timeline.clear();
+    }
+    setWindowTitle(nullptr, std::string("SOFA - " + fileName).c_str());
+
+    makeCurrentContext(m_firstWindow);
+
+    auto camera = getCamera();
+    if (camera)
+    {
+        camera->fitBoundingBox(newRoot->f_bbox.getValue().minBBox(), newRoot->f_bbox.getValue().maxBBox());
+        changeCamera(camera);
+    }
+
+    if (reload)
+        sofa::simulation::node::initTextures(newRoot.get()); // do not override OpenGL lights
+    else
+        initVisual();
+
+    m_guiEngine->resetCounter();
+
+    // update camera if a sidecar file is present
+    restoreCamera(getCamera());
+
+    m_initialState.capture(newRoot.get());
+
+    if (oldRoot)
+    {
+        sofa::simulation::node::unload(oldRoot);
+    }
+    msg_info("SofaGLFWBaseGUI") << fileName << " loaded in " << loadingTime << " s";
+}
+
+bool SofaGLFWBaseGUI::resetSimulation()
+{
+    const auto sceneLock = acquireScene();
+    if (!m_initialState.restore(this->groot.get()))
+    {
+        return false;
+    }
+
+    m_steppingController.cancel();
+    m_timeline.clear();
+    m_realTimeSynchronizer.restart();
+    redraw();
+    return true;
+}
+
+bool SofaGLFWBaseGUI::restoreTimelineFrame(std::size_t frameIndex)
+{
+    const auto sceneLock = acquireScene();
+    setSimulationIsRunning(false);
+    m_steppingController.cancel();
+    if (!m_timeline.restore(this->groot.get(), frameIndex))
+    {
+        return false;
+    }
+
+    m_realTimeSynchronizer.restart();
+    redraw();
+    return true;
+}
 
 bool SofaGLFWBaseGUI::simulationIsRunning() const
 {
@@ -162,6 +280,44 @@ bool SofaGLFWBaseGUI::simulationIsRunning() const
     return false;
 }
 
+SimulationThread::SceneLock SofaGLFWBaseGUI::acquireScene()
+{
+    if (m_simulationThread.isRunning())
+    {
+        return m_simulationThread.acquireScene();
+    }
+    return {};
+}
+
+void SofaGLFWBaseGUI::runInScene(std::function<void()> task)
+{
+    if (!m_simulationThread.isRunning())
+    {
+        task();
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_sceneTasksMutex);
+        m_sceneTasks.push_back(std::move(task));
+    }
+    // the simulation thread may be sleeping, e.g. while paused
+    m_simulationThread.notifyStateChanged();
+}
+
+void SofaGLFWBaseGUI::runSceneTasks()
+{
+    std::vector<std::function<void()>> tasks;
+    {
+        std::lock_guard<std::mutex> lock(m_sceneTasksMutex);
+        tasks.swap(m_sceneTasks);
+    }
+    for (const auto& task : tasks)
+    {
+        task();
+    }
+}
+
 void SofaGLFWBaseGUI::setSizeW(int width)
 {
     m_windowWidth = width;
@@ -184,6 +340,12 @@ int SofaGLFWBaseGUI::getHeight()
 
 void SofaGLFWBaseGUI::redraw()
 {
+    // may be called from any thread
+    m_nbPendingRedraws = s_nbRedrawsPerChange;
+    if (m_bGlfwIsInitialized)
+    {
+        glfwPostEmptyEvent();
+    }
 }
 
 void SofaGLFWBaseGUI::drawScene()
@@ -242,16 +404,8 @@ void SofaGLFWBaseGUI::setWindowIcon(GLFWwindow* glfwWindow)
     helper::system::DataRepository.removePath(SOFAGLFW_RESOURCES_DIR);
 }
 
-bool SofaGLFWBaseGUI::createWindow(int width, int height, const char* title, bool fullscreenAtStartup)
+GLFWwindow* SofaGLFWBaseGUI::createGLFWWindow(int width, int height, const char* title, bool fullscreenAtStartup)
 {
-    m_guiEngine->init();
-
-    if (this->groot == nullptr)
-    {
-        msg_error("SofaGLFWBaseGUI") << "No simulation root has been defined. Quitting.";
-        return false;
-    }
-
     GLFWwindow* glfwWindow = nullptr;
     if (fullscreenAtStartup)
     {
@@ -272,6 +426,61 @@ bool SofaGLFWBaseGUI::createWindow(int width, int height, const char* title, boo
     {
         glfwWindow = glfwCreateWindow(width > 0 ? width : 100, height > 0 ? height : 100, title, nullptr, m_firstWindow);
     }
+    return glfwWindow;
+}
+
+void SofaGLFWBaseGUI::setCoreProfileWindowHints(bool coreProfile)
+{
+    if (coreProfile)
+    {
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+#if defined(__APPLE__)
+        glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GLFW_TRUE);
+#endif
+    }
+    else
+    {
+        // the defaults of GLFW: the most recent compatibility context
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 1);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 0);
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_ANY_PROFILE);
+        glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GLFW_FALSE);
+    }
+}
+
+bool SofaGLFWBaseGUI::createWindow(int width, int height, const char* title, bool fullscreenAtStartup)
+{
+    m_guiEngine->init();
+    m_guiEngine->applySettings(this);
+
+    if (this->groot == nullptr)
+    {
+        msg_error("SofaGLFWBaseGUI") << "No simulation root has been defined. Quitting.";
+        return false;
+    }
+
+    // the profile is the same for all the windows, sharing the context of the first one
+    if (!m_firstWindow)
+    {
+        m_bCoreProfile = m_bCoreProfileRequested;
+        if (m_bCoreProfile && !m_guiEngine->supportsCoreProfile())
+        {
+            msg_warning("SofaGLFWBaseGUI") << "The GUI engine does not support the core profile: falling back to the legacy OpenGL profile.";
+            m_bCoreProfile = false;
+        }
+        setCoreProfileWindowHints(m_bCoreProfile);
+    }
+
+    GLFWwindow* glfwWindow = createGLFWWindow(width, height, title, fullscreenAtStartup);
+    if (!glfwWindow && m_bCoreProfile && !m_firstWindow)
+    {
+        msg_warning("SofaGLFWBaseGUI") << "Cannot create an OpenGL 3.3 core profile context: falling back to the legacy OpenGL profile.";
+        m_bCoreProfile = false;
+        setCoreProfileWindowHints(false);
+        glfwWindow = createGLFWWindow(width, height, title, fullscreenAtStartup);
+    }
     assert(glfwWindow);
     s_numberOfActiveWindows++;
 
@@ -300,6 +509,7 @@ bool SofaGLFWBaseGUI::createWindow(int width, int height, const char* title, boo
         glfwSetMonitorCallback(monitor_callback);
         glfwSetCharCallback(glfwWindow, character_callback);
         glfwSetWindowContentScaleCallback(glfwWindow, content_scale_callback);
+        glfwSetWindowRefreshCallback(glfwWindow, window_refresh_callback);
 
         glfwSetWindowUserPointer(glfwWindow, this);
 
@@ -308,6 +518,7 @@ bool SofaGLFWBaseGUI::createWindow(int width, int height, const char* title, boo
         m_guiEngine->initBackend(glfwWindow);
 
         SofaGLFWWindow* sofaWindow = new SofaGLFWWindow(glfwWindow, this->currentCamera);
+        sofaWindow->setCoreProfile(m_bCoreProfile);
 
         s_mapWindows[glfwWindow] = sofaWindow;
         s_mapGUIs[glfwWindow] = this;
@@ -441,6 +652,18 @@ void SofaGLFWBaseGUI::setWindowBackgroundImage(const std::string& filename, unsi
     }
 }
 
+void SofaGLFWBaseGUI::setWindowBackgroundGradient(const RGBAColor& bottomColor, const RGBAColor& topColor, unsigned int /* windowID */)
+{
+    if (hasWindow())
+    {
+        s_mapWindows[m_firstWindow]->setBackgroundGradient(bottomColor, topColor);
+    }
+    else
+    {
+        msg_error("SofaGLFWBaseGUI") << "No window to set the background in";// can happen with runSofa/BaseGUI
+    }
+}
+
 void SofaGLFWBaseGUI::setWindowTitle(GLFWwindow* window, const char* title)
 {
     if(hasWindow())
@@ -460,6 +683,8 @@ void SofaGLFWBaseGUI::makeCurrentContext(GLFWwindow* glfwWindow)
     glfwSwapInterval( 0 ); //request disabling vsync
     if (!m_bGlewIsInitialized)
     {
+        // the extensions of a core profile context are not listed in the way older versions of GLEW look them up
+        glewExperimental = m_bCoreProfile ? GL_TRUE : GL_FALSE;
         glewInit();
         m_bGlewIsInitialized = true;
     }
@@ -477,19 +702,75 @@ std::size_t SofaGLFWBaseGUI::runLoop(std::size_t targetNbIterations)
     m_viewPortWidth = m_vparams->viewport()[2];
     m_viewPortHeight = m_vparams->viewport()[3];
 
+    // the state to come back to when resetting the simulation
+    if (!m_initialState.isCapturedFrom(this->groot.get()))
+    {
+        m_initialState.capture(this->groot.get());
+    }
+
     bool running = true;
     std::size_t currentNbIterations = 0;
     std::stringstream tmpStr;
-    std::vector<uint8_t> pixels;
+
+    using Clock = std::chrono::steady_clock;
+    const auto elapsedSince = [](Clock::time_point start)
+    {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    };
 
     while (s_numberOfActiveWindows > 0 && running)
     {
         SIMULATION_LOOP_SCOPE
 
-        // Keep running
-        runStep();
+        // mouse events received since the previous iteration
+        processInputEvents();
+
+        // a scene loaded in the background replaces the current one
+        if (m_sceneLoader.isReady())
+        {
+            finishSceneLoading();
+        }
+
+        const bool isIdle = updateIdleState();
+        const bool frameIsDue = !isIdle && isFrameDue();
+        std::size_t nbStepsThisIteration = 0;
+        const auto iterationStart = Clock::now();
+        FrameTimings frameTimings;
+        frameTimings.frameIndex = m_frameIndex++;
+        frameTimings.startTime = glfwGetTime();
+
+        // Keep running. An offline recording needs the frames drawn in lockstep with the steps.
+        if (m_bSimulationThreaded && !m_bOfflineRecording)
+        {
+            if (!m_simulationThread.isRunning())
+            {
+                m_simulationThread.setHandOverCallback([]() { glfwPostEmptyEvent(); });
+                m_simulationThread.start([this](std::size_t maxNbSteps) { runSceneTasks(); return runStep(true, maxNbSteps); }, targetNbIterations,
+                                         [this]() { return getIdleTime(); });
+            }
+            else
+            {
+                // the events handled by the previous iteration (GUI, keyboard) may have given steps to compute
+                m_simulationThread.notifyStateChanged();
+            }
+        }
+        else
+        {
+            m_simulationThread.stop();
+            runSceneTasks();
+
+            // the visual models are only updated if they are going to be drawn
+            const std::size_t maxNbSteps = (targetNbIterations > 0) ? targetNbIterations - currentNbIterations : 0;
+            const auto stepStart = Clock::now();
+            nbStepsThisIteration = runStep(frameIsDue, maxNbSteps);
+            frameTimings.step = elapsedSince(stepStart);
+            currentNbIterations += nbStepsThisIteration;
+        }
+        frameTimings.nbSteps = nbStepsThisIteration;
+
         sofa::type::vector<std::pair<GLFWwindow*, SofaGLFWWindow*>> closedWindows;
-        
+        bool isWaitingForStep = false;
+
         for (auto& [glfwWindow, sofaGlfwWindow] : s_mapWindows)
         {
             if (glfwWindow && sofaGlfwWindow)
@@ -497,29 +778,130 @@ std::size_t SofaGLFWBaseGUI::runLoop(std::size_t targetNbIterations)
                 // while user did not request to close this window (i.e press escape), draw
                 if (!glfwWindowShouldClose(glfwWindow) && !m_guiEngine->isTerminated())
                 {
+                    if (!frameIsDue)
+                    {
+                        continue;
+                    }
+
                     makeCurrentContext(glfwWindow);
-                    
-                    m_guiEngine->beforeDraw(glfwWindow);
-                    sofaGlfwWindow->draw(this->groot, m_vparams);
 
-                    drawSelection(m_vparams);
+                    // With a threaded simulation, the scene is drawn only when it is not being computed: the render loop
+                    // never waits for a step. The simulation thread wakes it up at the end of the step in progress.
+                    SimulationThread::SceneLock sceneLock;
+                    if (m_simulationThread.isRunning())
+                    {
+                        sceneLock = m_simulationThread.tryAcquireScene();
+                    }
+                    const bool drawScene = !m_simulationThread.isRunning() || sceneLock.owns_lock();
+                    if (!drawScene && !m_guiEngine->hasPersistentSceneFrame())
+                    {
+                        // nothing to show without the scene: the window keeps its last frame
+                        isWaitingForStep = true;
+                        continue;
+                    }
 
-                    m_guiEngine->afterDraw();
+                    const auto drawStart = Clock::now();
+                    double selectionTime = 0.0;
+                    m_guiEngine->beforeDraw(glfwWindow);
+                    if (drawScene)
+                    {
+                        sofaGlfwWindow->draw(this->groot, m_vparams);
+
+                        const auto selectionStart = Clock::now();
+                        drawSelection(m_vparams);
+                        selectionTime = elapsedSince(selectionStart);
+
+                        // the poster is rendered off-screen, from the scene as it is drawn
+                        if (m_tiledScreenshotRequest && glfwWindow == m_firstWindow)
+                        {
+                            saveTiledScreenshot(sofaGlfwWindow, *m_tiledScreenshotRequest);
+                            m_tiledScreenshotRequest.reset();
+                            // posters are occasional: their band and frame buffer are not kept
+                            m_tiledRenderer.release();
+                        }
+                    }
 
-                    m_guiEngine->startFrame(this);
-                    m_guiEngine->endFrame();
+                    m_guiEngine->afterDraw();
+                    frameTimings.selection += selectionTime;
+                    frameTimings.draw += elapsedSince(drawStart) - selectionTime;
+
+                    // the GUI reads and edits the scene: while a step is computed, the engine shows its last frame again
+                    // and keeps the inputs for the next one, or the window keeps its last frame
+                    const auto guiStart = Clock::now();
+                    bool isFrameSwapped = true;
+                    if (drawScene)
+                    {
+                        m_guiEngine->startFrame(this);
+                        m_guiEngine->endFrame();
+                    }
+                    else
+                    {
+                        isWaitingForStep = true;
+                        isFrameSwapped = m_guiEngine->redrawLastFrame();
+                    }
+                    frameTimings.gui += elapsedSince(guiStart);
                     
                     m_viewPortHeight = m_vparams->viewport()[3];
                     m_viewPortWidth = m_vparams->viewport()[2];
-                    
-                    // Read framebuffer
-                    if(this->groot->getAnimate() && this->m_bVideoRecording)
+
+                    if (m_bVideoRecordingAtStartup)
+                    {
+                        m_bVideoRecordingAtStartup = false;
+                        if (!m_bVideoRecording)
+                        {
+                            toggleVideoRecording();
+                        }
+                    }
+
+                    if (m_bFrameStreamRequested && !m_framePublisher.isOpen())
                     {
-                        const auto [width, height] = this->m_guiEngine->getFrameBufferPixels(pixels);
-                        m_videoRecorderFFMPEG.addFrame(pixels.data(), width, height);
+                        openFrameStream();
                     }
 
-                    glfwSwapBuffers(glfwWindow);
+                    // Read framebuffer, the frame is encoded on the encoder thread.
+                    // An offline recording only records the frames following the steps it computed.
+                    // The frame stream shares the readback: it publishes the recorded frames while recording.
+                    const bool isFrameRecorded = m_bOfflineRecording ? nbStepsThisIteration > 0 : this->groot->getAnimate();
+                    const bool isRecordedFrameRead = isFrameRecorded && this->m_bVideoRecording && m_videoEncoder.isFrameWanted();
+                    const bool isStreamedFrameRead = !this->m_bVideoRecording && m_framePublisher.isOpen();
+                    if(drawScene && (isRecordedFrameRead || isStreamedFrameRead))
+                    {
+                        const auto readbackStart = Clock::now();
+                        this->m_guiEngine->setFrameBufferReadbackTime(this->groot->getTime());
+                        PixelFramePtr frame;
+                        if (!this->m_bVideoRecording)
+                            frame = this->m_guiEngine->readFrameBuffer(m_frameStreamSize);
+                        else if (m_videoFrameFormat == PixelFormat::YUV420)
+                            frame = this->m_guiEngine->readFrameBufferYUV420(m_videoSize);
+                        else
+                            frame = this->m_guiEngine->readFrameBuffer(m_videoSize);
+                        frameTimings.readback += elapsedSince(readbackStart);
+                        // no frame while the asynchronous readback fills up
+                        if (frame && frame->getNbBytes() > 0)
+                        {
+                            if (m_framePublisher.isOpen())
+                            {
+                                m_framePublisher.publish(*frame);
+                            }
+                            if (this->m_bVideoRecording)
+                            {
+                                m_videoEncoder.push(std::move(frame));
+                            }
+                        }
+                    }
+
+                    // let the simulation thread continue while waiting for the swap
+                    if (sceneLock.owns_lock())
+                    {
+                        sceneLock.unlock();
+                    }
+
+                    if (isFrameSwapped)
+                    {
+                        const auto swapStart = Clock::now();
+                        glfwSwapBuffers(glfwWindow);
+                        frameTimings.swap += elapsedSince(swapStart);
+                    }
 
                 }
                 else
@@ -530,12 +912,57 @@ std::size_t SofaGLFWBaseGUI::runLoop(std::size_t targetNbIterations)
             }
         }
 
-        glfwPollEvents();
+        const auto pollStart = Clock::now();
+        const bool isStepping = !m_simulationThread.isRunning() && (simulationIsRunning() || m_steppingController.isBusy());
+        if (isIdle)
+        {
+            // nothing has changed: sleep until an event arrives (redraw() posts an empty one)
+            glfwWaitEventsTimeout(s_idleRefreshPeriod);
+        }
+        else if (isWaitingForStep)
+        {
+            // a step is in progress: handle the events until the simulation thread hands the scene over (it posts an empty event)
+            glfwWaitEventsTimeout(s_idleRefreshPeriod);
+        }
+        else if (!frameIsDue && !isStepping)
+        {
+            // nothing to compute on this thread until the next frame
+            glfwWaitEventsTimeout(std::max(0.0, m_lastFrameTime + 1.0 / m_maxFrameRate - glfwGetTime()));
+        }
+        else if (isStepping && m_bRealTime && nbStepsThisIteration == 0)
+        {
+            // ahead of the wall-clock time: nothing to compute until the next step or the next frame
+            double timeout = m_realTimeSynchronizer.getTimeUntilNextStep(this->groot->getTime(), this->groot->getDt());
+            if (m_maxFrameRate > 0.0)
+            {
+                timeout = std::min(timeout, std::max(0.0, m_lastFrameTime + 1.0 / m_maxFrameRate - glfwGetTime()));
+            }
+            glfwWaitEventsTimeout(timeout);
+        }
+        else
+        {
+            glfwPollEvents();
+        }
+        frameTimings.poll = elapsedSince(pollStart);
+        frameTimings.total = elapsedSince(iterationStart);
+
+        if (frameTimings.nbSteps > 0 || frameIsDue)
+        {
+            m_frameTimingsHistory.push(frameTimings);
+            if (m_frameTimingsCallback)
+            {
+                m_frameTimingsCallback(frameTimings);
+            }
+        }
 
         // the engine must be terminated before the window
         if (s_numberOfActiveWindows == closedWindows.size())
         {
             // could be not necessary if m_guiEngine already terminated but we may need it if GLFW closed itself. (typically escape key)
+            if (m_bVideoRecording)
+            {
+                toggleVideoRecording();
+            }
             m_guiEngine->terminate();
             m_guiEngine.reset();
         }
@@ -552,8 +979,22 @@ std::size_t SofaGLFWBaseGUI::runLoop(std::size_t targetNbIterations)
             }
         }
 
-        currentNbIterations++;
-        running = (targetNbIterations > 0) ? currentNbIterations < targetNbIterations : true;
+        if (targetNbIterations > 0)
+        {
+            running = m_simulationThread.isRunning() ? !m_simulationThread.hasReachedMaxNbSteps() : currentNbIterations < targetNbIterations;
+        }
+        if (m_bQuitWhenSteppingDone && !m_steppingController.isBusy())
+        {
+            running = false;
+        }
+    }
+
+    // an iteration is a simulation step, not a displayed frame
+    if (m_simulationThread.isRunning())
+    {
+        currentNbIterations = m_simulationThread.getNbSteps();
+        m_simulationThread.stop();
+        runSceneTasks();
     }
 
     return currentNbIterations;
@@ -581,31 +1022,33 @@ void SofaGLFWBaseGUI::initVisual()
     //init gl states
     glDepthFunc(GL_LEQUAL);
     glClearDepth(1.0);
-    glEnable(GL_NORMALIZE);
 
-    glHint(GL_PERSPECTIVE_CORRECTION_HINT, GL_NICEST);
+    // in a core profile, the light is given to the shaders by the uniform buffer of the windows
+    if (!m_bCoreProfile)
+    {
+        glEnable(GL_NORMALIZE);
+
+        glHint(GL_PERSPECTIVE_CORRECTION_HINT, GL_NICEST);
 
-    // Setup 'light 0'
-    float lightAmbient[4] = { 0.5f, 0.5f, 0.5f,1.0f };
-    float lightDiffuse[4] = { 0.9f, 0.9f, 0.9f,1.0f };
-    float lightSpecular[4] = { 1.0f, 1.0f, 1.0f,1.0f };
-    float lightPosition[4] = { -0.7f, 0.3f, 0.0f,1.0f };
-    glLightfv(GL_LIGHT0, GL_AMBIENT, lightAmbient);
-    glLightfv(GL_LIGHT0, GL_DIFFUSE, lightDiffuse);
-    glLightfv(GL_LIGHT0, GL_SPECULAR, lightSpecular);
-    glLightfv(GL_LIGHT0, GL_POSITION, lightPosition);
+        // Setup 'light 0'
+        const ViewerLight light;
+        glLightfv(GL_LIGHT0, GL_AMBIENT, light.ambient.data());
+        glLightfv(GL_LIGHT0, GL_DIFFUSE, light.diffuse.data());
+        glLightfv(GL_LIGHT0, GL_SPECULAR, light.specular.data());
+        glLightfv(GL_LIGHT0, GL_POSITION, light.position.data());
 
-    // Enable color tracking
-    glColorMaterial(GL_FRONT_AND_BACK, GL_AMBIENT_AND_DIFFUSE);
+        // Enable color tracking
+        glColorMaterial(GL_FRONT_AND_BACK, GL_AMBIENT_AND_DIFFUSE);
 
-    // All materials hereafter have full specular reflectivity with a high shine
-    float materialSpecular[4] = { 1.0f, 1.0f, 1.0f,1.0f };
-    glMaterialfv(GL_FRONT, GL_SPECULAR, materialSpecular);
-    glMateriali(GL_FRONT, GL_SHININESS, 128);
+        // All materials hereafter have full specular reflectivity with a high shine
+        float materialSpecular[4] = { 1.0f, 1.0f, 1.0f,1.0f };
+        glMaterialfv(GL_FRONT, GL_SPECULAR, materialSpecular);
+        glMateriali(GL_FRONT, GL_SHININESS, 128);
 
-    glShadeModel(GL_SMOOTH);
+        glShadeModel(GL_SMOOTH);
 
-    glEnable(GL_LIGHT0);
+        glEnable(GL_LIGHT0);
+    }
 
     m_vparams = VisualParams::defaultInstance();
     for (auto& [glfwWindow, sofaGlfwWindow] : s_mapWindows)
@@ -616,17 +1059,188 @@ void SofaGLFWBaseGUI::initVisual()
     setWindowBackgroundImage("textures/SOFA_logo.bmp", 0);
 }
 
-void SofaGLFWBaseGUI::runStep()
+void SofaGLFWBaseGUI::setRealTime(bool realTime)
 {
-    if(simulationIsRunning())
+    // the synchronizer is used by the steps, possibly computed on the simulation thread
+    const auto sceneLock = acquireScene();
+    m_bRealTime = realTime;
+    m_realTimeSynchronizer.restart();
+}
+
+double SofaGLFWBaseGUI::getIdleTime() const
+{
+    if (m_bRealTime && simulationIsRunning() && !m_steppingController.isBusy())
+    {
+        return m_realTimeSynchronizer.getTimeUntilNextStep(this->groot->getTime(), this->groot->getDt());
+    }
+    // paused: nothing to compute until something changes
+    return std::numeric_limits<double>::infinity();
+}
+
+std::size_t SofaGLFWBaseGUI::runStep(bool updateVisual, std::size_t maxNbSteps)
+{
+    Node* root = this->groot.get();
+
+    // the steps computed without updating the visual models are displayed by the next drawn frame, even without a new step
+    const auto updatePendingVisual = [this, root](bool isFrameDrawn)
+    {
+        if (isFrameDrawn && m_bVisualUpdatePending)
+        {
+            node::updateVisual(root);
+            m_bVisualUpdatePending = false;
+        }
+    };
+
+    const bool hasCommand = m_steppingController.isBusy();
+    if (!hasCommand && !simulationIsRunning())
     {
-        helper::AdvancedTimer::begin("Animate");
+        // the wall-clock time spent in pause must not be caught up
+        m_realTimeSynchronizer.restart();
+        updatePendingVisual(updateVisual);
+        return 0;
+    }
 
-        node::animate(this->groot.get(), this->groot->getDt());
-        node::updateVisual(this->groot.get());
+    std::size_t nbSteps = 0;
+    const bool isOfflineRecording = m_bVideoRecording && m_bOfflineRecording;
+    if (!hasCommand && isOfflineRecording)
+    {
+        // the steps up to the next recorded frame, as fast as possible
+        nbSteps = m_offlineRecordingSteps;
+        if (maxNbSteps > 0)
+        {
+            nbSteps = std::min(nbSteps, maxNbSteps);
+        }
+    }
+    else if (!hasCommand)
+    {
+        nbSteps = m_nbStepsPerFrame;
+        if (m_bRealTime)
+        {
+            nbSteps = m_realTimeSynchronizer.computeNbSteps(root->getTime(), root->getDt());
+            if (nbSteps == 0)
+            {
+                updatePendingVisual(updateVisual);
+                return 0;
+            }
+        }
+        if (maxNbSteps > 0)
+        {
+            nbSteps = std::min(nbSteps, maxNbSteps);
+        }
+    }
 
-        helper::AdvancedTimer::end("Animate");
+    helper::AdvancedTimer::begin("Animate");
+
+    // every step is recorded, so that any recent step can be restored (the memory budget bounds the cost)
+    const auto animate = [this, root]()
+    {
+        node::animate(root, root->getDt());
+        m_timeline.record(root);
+    };
+    if (hasCommand)
+    {
+        nbSteps = m_steppingController.execute(root, s_steppingSliceDuration, maxNbSteps, animate);
+
+        // the end of a command is always displayed
+        updateVisual = updateVisual || !m_steppingController.isBusy();
+        m_realTimeSynchronizer.restart();
     }
+    else if (isOfflineRecording && m_offlineRecordingTimeStep > 0.0)
+    {
+        // the simulated time has been moved (reset, timeline): the frames restart from the current time
+        const double tolerance = 1e-6 * root->getDt();
+        if (m_nextRecordedFrameTime <= root->getTime() + tolerance
+            || m_nextRecordedFrameTime > root->getTime() + m_offlineRecordingTimeStep + tolerance)
+        {
+            m_nextRecordedFrameTime = root->getTime() + m_offlineRecordingTimeStep;
+        }
+
+        while (root->getTime() + tolerance < m_nextRecordedFrameTime && (maxNbSteps == 0 || nbSteps < maxNbSteps))
+        {
+            animate();
+            ++nbSteps;
+        }
+        m_nextRecordedFrameTime += m_offlineRecordingTimeStep;
+    }
+    else
+    {
+        for (std::size_t i = 0; i < nbSteps; ++i)
+        {
+            animate();
+        }
+    }
+
+    if (nbSteps > 0)
+    {
+        m_bVisualUpdatePending = true;
+    }
+    updatePendingVisual(updateVisual);
+
+    helper::AdvancedTimer::end("Animate");
+    return nbSteps;
+}
+
+std::size_t SofaGLFWBaseGUI::runSteppingCommands()
+{
+    m_bQuitWhenSteppingDone = true;
+    const std::size_t nbSteps = runLoop();
+    m_bQuitWhenSteppingDone = false;
+    return nbSteps;
+}
+
+bool SofaGLFWBaseGUI::isFrameDue()
+{
+    // an offline recording draws a frame after each batch of steps, whatever the time it takes
+    if (m_maxFrameRate <= 0.0 || (m_bVideoRecording && m_bOfflineRecording))
+        return true;
+
+    const double currentTime = glfwGetTime();
+    if (currentTime - m_lastFrameTime >= 1.0 / m_maxFrameRate)
+    {
+        m_lastFrameTime = currentTime;
+        return true;
+    }
+    return false;
+}
+
+bool SofaGLFWBaseGUI::updateIdleState()
+{
+    bool hasChanged = !m_bIdleWhenPaused || simulationIsRunning() || m_steppingController.isBusy() || m_bVideoRecording || m_sceneLoader.isBusy();
+
+    if (currentCamera)
+    {
+        const auto& position = currentCamera->getPosition();
+        const auto& orientation = currentCamera->getOrientation();
+        if (position != m_lastCameraPosition || !(orientation == m_lastCameraOrientation))
+        {
+            m_lastCameraPosition = position;
+            m_lastCameraOrientation = orientation;
+            hasChanged = true;
+        }
+    }
+
+    if (hasChanged)
+    {
+        m_nbPendingRedraws = s_nbRedrawsPerChange;
+    }
+
+    const double currentTime = glfwGetTime();
+    if (m_nbPendingRedraws > 0)
+    {
+        --m_nbPendingRedraws;
+        m_bIsIdle = false;
+    }
+    else
+    {
+        // redraw from time to time anyway, for the changes which are not tracked (e.g. a Data modified by a script)
+        m_bIsIdle = currentTime - m_lastIdleRefreshTime < s_idleRefreshPeriod;
+    }
+
+    if (!m_bIsIdle)
+    {
+        m_lastIdleRefreshTime = currentTime;
+    }
+    return m_bIsIdle;
 }
 
 void SofaGLFWBaseGUI::terminate()
@@ -634,13 +1248,18 @@ void SofaGLFWBaseGUI::terminate()
     if (!m_bGlfwIsInitialized)
         return;
 
-    if (m_guiEngine)
-        m_guiEngine->terminate();
+    m_simulationThread.stop();
 
+    // the encoder holds frames read back by the engine
     if(m_bVideoRecording)
     {
-        m_videoRecorderFFMPEG.finishVideo();
+        toggleVideoRecording();
     }
+
+    stopFrameStream();
+
+    if (m_guiEngine)
+        m_guiEngine->terminate();
     
     glfwTerminate();
 }
@@ -667,6 +1286,7 @@ int SofaGLFWBaseGUI::handleArrowKeys(int key)
 
 void SofaGLFWBaseGUI::key_callback(GLFWwindow* window, int key, int scancode, int action, int mods)
 {
+    requestRedraw(window);
     SOFA_UNUSED(scancode);
     SOFA_UNUSED(mods);
 
@@ -691,6 +1311,9 @@ void SofaGLFWBaseGUI::key_callback(GLFWwindow* window, int key, int scancode, in
         return;
     }
 
+    // the shortcuts below may modify the scene
+    const auto sceneLock = currentGUI->acquireScene();
+
     // Key events are forwarded to SOFA using: CTRL + SHIFT
     if (isCtrlKeyPressed && isShiftKeyPressed)
     {
@@ -815,6 +1438,12 @@ void SofaGLFWBaseGUI::key_callback(GLFWwindow* window, int key, int scancode, in
                 }
                 break;
             }
+            // N: Compute the next step (queued after the stepping commands in progress)
+            case GLFW_KEY_N:
+            {
+                currentGUI->m_steppingController.stepN(1);
+                break;
+            }
             // R: Reload the file
             case GLFW_KEY_O:
             {
@@ -928,6 +1557,7 @@ void SofaGLFWBaseGUI::moveRayPickInteractor(int eventX, int eventY)
 
 void SofaGLFWBaseGUI::window_pos_callback(GLFWwindow* window, int xpos, int ypos)
 {
+    requestRedraw(window);
     SofaGLFWBaseGUI* gui = static_cast<SofaGLFWBaseGUI*>(glfwGetWindowUserPointer(window));
     gui->m_windowPosition[0] = static_cast<float>(xpos);
     gui->m_windowPosition[1] = static_cast<float>(ypos);
@@ -935,56 +1565,55 @@ void SofaGLFWBaseGUI::window_pos_callback(GLFWwindow* window, int xpos, int ypos
 
 void SofaGLFWBaseGUI::mouse_button_callback(GLFWwindow* window, int button, int action, int mods)
 {
+    requestRedraw(window);
+
     auto currentGUI = s_mapGUIs.find(window);
     if (currentGUI == s_mapGUIs.end() || !currentGUI->second) {
         return;
     }
 
-    SofaGLFWBaseGUI* gui = currentGUI->second;
+    const bool shiftPressed = glfwGetKey(window, GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS || glfwGetKey(window, GLFW_KEY_RIGHT_SHIFT) == GLFW_PRESS;
+    if (!shiftPressed && !currentGUI->second->getGUIEngine()->dispatchMouseEvents())
+        return;
+
+    // the cursor may have moved again by the time the event is handled
+    double xpos, ypos;
+    glfwGetCursorPos(window, &xpos, &ypos);
+    currentGUI->second->pushInputEvent({InputEvent::Type::MouseButton, window, xpos, ypos, button, action, mods, shiftPressed});
+}
 
-    auto rootNode = currentGUI->second->getRootNode();
+void SofaGLFWBaseGUI::handleMouseButton(const InputEvent& event)
+{
+    auto rootNode = getRootNode();
     if (!rootNode) {
         return;
     }
 
-    const bool shiftPressed = glfwGetKey(window, GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS || glfwGetKey(window, GLFW_KEY_RIGHT_SHIFT) == GLFW_PRESS;
+    const auto currentSofaWindow = s_mapWindows.find(event.window);
+    if (currentSofaWindow == s_mapWindows.end() || !currentSofaWindow->second) {
+        return;
+    }
 
-    if (shiftPressed )
+    if (event.shiftPressed)
     {
         // Check if the animation is running
-        if (!currentGUI->second->simulationIsRunning())
+        if (!simulationIsRunning())
         {
             msg_info("SofaGLFWBaseGUI") << "Animation is not running. Ignoring mouse interaction.";
             return;
         }
 
-        const auto currentSofaWindow = s_mapWindows.find(window);
-        if (currentSofaWindow != s_mapWindows.end() && currentSofaWindow->second)
+        translateToViewportCoordinates(this, event.x, event.y);
+
+        // picking modifies the scene
+        runInScene([sofaWindow = currentSofaWindow->second, event, width = m_viewPortWidth, height = m_viewPortHeight, cursorPos = m_translatedCursorPos]()
         {
-            double xpos, ypos;
-            glfwGetCursorPos(window, &xpos, &ypos);
-            translateToViewportCoordinates(gui,xpos,ypos);
-
-            currentSofaWindow->second->mouseEvent(
-                window, gui->m_viewPortWidth, gui->m_viewPortHeight, button,
-                action, mods,
-                gui->m_translatedCursorPos[0],
-                gui->m_translatedCursorPos[1]);
-        }
+            sofaWindow->mouseEvent(event.window, width, height, event.button, event.action, event.mods, cursorPos[0], cursorPos[1]);
+        });
     }
     else
     {
-        if (currentGUI != s_mapGUIs.end() && currentGUI->second)
-        {
-            if (!currentGUI->second->getGUIEngine()->dispatchMouseEvents())
-                return;
-        }
-
-        auto currentSofaWindow = s_mapWindows.find(window);
-        if (currentSofaWindow != s_mapWindows.end() && currentSofaWindow->second)
-        {
-            currentSofaWindow->second->mouseButtonEvent(button, action, mods);
-        }
+        currentSofaWindow->second->mouseButtonEvent(event.button, event.action, event.mods);
     }
 }
 
@@ -995,6 +1624,7 @@ void SofaGLFWBaseGUI::translateToViewportCoordinates (SofaGLFWBaseGUI* gui,doubl
 
 void SofaGLFWBaseGUI::content_scale_callback(GLFWwindow *window, float xscale, float yscale)
 {
+    requestRedraw(window);
     auto currentGUI = s_mapGUIs[window];
     if (currentGUI && currentGUI->m_guiEngine)
     {
@@ -1002,57 +1632,114 @@ void SofaGLFWBaseGUI::content_scale_callback(GLFWwindow *window, float xscale, f
     }
 }
 
-void SofaGLFWBaseGUI::cursor_position_callback(GLFWwindow* window, double xpos, double ypos)
+void SofaGLFWBaseGUI::window_refresh_callback(GLFWwindow* window)
 {
-    auto currentGUI = s_mapGUIs.find(window);
+    // the content of the window has been damaged (resize, exposure...)
+    requestRedraw(window);
+}
 
+void SofaGLFWBaseGUI::requestRedraw(GLFWwindow* window)
+{
+    const auto currentGUI = s_mapGUIs.find(window);
     if (currentGUI != s_mapGUIs.end() && currentGUI->second)
     {
-        if (!currentGUI->second->getGUIEngine()->dispatchMouseEvents())
-            return;
+        currentGUI->second->m_nbPendingRedraws = s_nbRedrawsPerChange;
     }
-    SofaGLFWBaseGUI* gui = currentGUI->second;
+}
+
+void SofaGLFWBaseGUI::cursor_position_callback(GLFWwindow* window, double xpos, double ypos)
+{
+    requestRedraw(window);
 
-    translateToViewportCoordinates(gui,xpos,ypos);
+    auto currentGUI = s_mapGUIs.find(window);
+    if (currentGUI == s_mapGUIs.end() || !currentGUI->second)
+        return;
 
-    bool shiftPressed = glfwGetKey(window, GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS || glfwGetKey(window, GLFW_KEY_RIGHT_SHIFT) == GLFW_PRESS;
+    if (!currentGUI->second->getGUIEngine()->dispatchMouseEvents())
+        return;
 
+    const bool shiftPressed = glfwGetKey(window, GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS || glfwGetKey(window, GLFW_KEY_RIGHT_SHIFT) == GLFW_PRESS;
+    currentGUI->second->pushInputEvent({InputEvent::Type::CursorPosition, window, xpos, ypos, -1, -1, 0, shiftPressed});
+}
 
-    auto currentSofaWindow = s_mapWindows.find(window);
+void SofaGLFWBaseGUI::handleCursorPosition(const InputEvent& event)
+{
+    translateToViewportCoordinates(this, event.x, event.y);
 
-    if (shiftPressed)
+    auto currentSofaWindow = s_mapWindows.find(event.window);
+    if (currentSofaWindow == s_mapWindows.end() || !currentSofaWindow->second)
+        return;
+
+    if (event.shiftPressed)
     {
+        // picking modifies the scene
         for (const auto button : {GLFW_MOUSE_BUTTON_LEFT, GLFW_MOUSE_BUTTON_MIDDLE, GLFW_MOUSE_BUTTON_RIGHT})
         {
-            if (glfwGetMouseButton(window, button) == GLFW_PRESS)
+            if (glfwGetMouseButton(event.window, button) == GLFW_PRESS)
             {
-                currentSofaWindow->second->mouseEvent(window,gui->m_viewPortWidth,gui->m_viewPortHeight, button, 1, 1, gui->m_translatedCursorPos[0], gui->m_translatedCursorPos[1]);
+                runInScene([sofaWindow = currentSofaWindow->second, window = event.window, button, width = m_viewPortWidth, height = m_viewPortHeight, cursorPos = m_translatedCursorPos]()
+                {
+                    sofaWindow->mouseEvent(window, width, height, button, 1, 1, cursorPos[0], cursorPos[1]);
+                });
             }
         }
     }
 
-    if (currentSofaWindow != s_mapWindows.end() && currentSofaWindow->second)
-    {
-        currentSofaWindow->second->mouseMoveEvent(static_cast<int>(xpos), static_cast<int>(ypos), currentGUI->second);
-    }
+    currentSofaWindow->second->mouseMoveEvent(static_cast<int>(event.x), static_cast<int>(event.y), this);
 }
 
 void SofaGLFWBaseGUI::scroll_callback(GLFWwindow* window, double xoffset, double yoffset)
 {
+    requestRedraw(window);
+
     auto currentGUI = s_mapGUIs.find(window);
-    if (currentGUI != s_mapGUIs.end() && currentGUI->second)
+    if (currentGUI == s_mapGUIs.end() || !currentGUI->second)
+        return;
+
+    if (!currentGUI->second->getGUIEngine()->dispatchMouseEvents())
+        return;
+
+    currentGUI->second->pushInputEvent({InputEvent::Type::Scroll, window, xoffset, yoffset, -1, -1, 0, false});
+}
+
+void SofaGLFWBaseGUI::handleScroll(const InputEvent& event)
+{
+    auto currentSofaWindow = s_mapWindows.find(event.window);
+    if (currentSofaWindow != s_mapWindows.end() && currentSofaWindow->second)
     {
-        if (!currentGUI->second->getGUIEngine()->dispatchMouseEvents())
-            return;
+        currentSofaWindow->second->scrollEvent(event.x, event.y);
     }
+}
 
-    auto currentSofaWindow = s_mapWindows.find(window);
-    if (currentSofaWindow != s_mapWindows.end() && currentSofaWindow->second)
+void SofaGLFWBaseGUI::pushInputEvent(const InputEvent& event)
+{
+    if (!m_inputEvents.push(event))
     {
-        currentSofaWindow->second->scrollEvent(xoffset, yoffset);
+        // full: handle the pending events right away rather than losing some
+        processInputEvents();
+        m_inputEvents.push(event);
     }
 }
 
+void SofaGLFWBaseGUI::processInputEvents()
+{
+    m_inputEvents.dispatch([this](const InputEvent& event)
+    {
+        switch (event.type)
+        {
+            case InputEvent::Type::CursorPosition:
+                handleCursorPosition(event);
+                break;
+            case InputEvent::Type::MouseButton:
+                handleMouseButton(event);
+                break;
+            case InputEvent::Type::Scroll:
+                handleScroll(event);
+                break;
+        }
+    });
+}
+
 void SofaGLFWBaseGUI::close_callback(GLFWwindow* window)
 {
     SOFA_UNUSED(window);
@@ -1060,7 +1747,7 @@ void SofaGLFWBaseGUI::close_callback(GLFWwindow* window)
 
 void SofaGLFWBaseGUI::window_focus_callback(GLFWwindow* window, int focused)
 {
-    SOFA_UNUSED(window);
+    requestRedraw(window);
     SOFA_UNUSED(focused);
     //if (focused)
     //{
@@ -1073,7 +1760,7 @@ void SofaGLFWBaseGUI::window_focus_callback(GLFWwindow* window, int focused)
 }
 void SofaGLFWBaseGUI::cursor_enter_callback(GLFWwindow* window, int entered)
 {
-    SOFA_UNUSED(window);
+    requestRedraw(window);
     SOFA_UNUSED(entered);
 
     //if (entered)
@@ -1102,7 +1789,7 @@ void SofaGLFWBaseGUI::monitor_callback(GLFWmonitor* monitor, int event)
 
 void SofaGLFWBaseGUI::character_callback(GLFWwindow* window, unsigned int codepoint)
 {
-    SOFA_UNUSED(window);
+    requestRedraw(window);
     SOFA_UNUSED(codepoint);
 
     // The callback function receives Unicode code points for key events
@@ -1197,23 +1884,107 @@ void SofaGLFWBaseGUI::toggleVideoRecording()
     if(m_bVideoRecording)
     {
         m_bVideoRecording = false;
-        m_videoRecorderFFMPEG.finishVideo();
-        msg_info("SofaGLFWBaseGUI") << "End recording";
+
+        // the last frames drawn are still being read back
+        while (auto frame = m_guiEngine->readPendingFrameBuffer())
+        {
+            if (frame->getNbBytes() > 0)
+            {
+                m_videoEncoder.push(std::move(frame));
+            }
+        }
+
+        // the queued frames are encoded before the video is closed
+        m_videoEncoder.stop();
+        if (m_bRecordingImageSequence)
+        {
+            m_imageSequenceWriter.stop();
+            m_bRecordingImageSequence = false;
+            msg_info("SofaGLFWBaseGUI") << m_imageSequenceWriter.getNbWrittenImages() << " images written into " << m_imageSequenceDirectory.string()
+                                        << " (" << m_imageSequenceWriter.getNbFailedImages() << " failed)";
+        }
+        else if (m_bRecordingThroughPipe)
+        {
+            m_videoPipe.close();
+        }
+        else
+        {
+            m_videoRecorderFFMPEG.finishVideo();
+        }
+
+        const auto stats = m_videoEncoder.getStats();
+        msg_info("SofaGLFWBaseGUI") << "End recording: " << stats.nbEncodedFrames << " frames encoded, "
+                                    << stats.nbDroppedFrames << " frames dropped ('" << VideoEncoderThread::toString(m_videoEncoder.getQueuePolicy()) << "' policy)";
+
+        if (m_bOfflineRecording)
+        {
+            m_bOfflineRecording = false;
+            m_videoEncoder.setQueuePolicy(m_queuePolicyBeforeOfflineRecording);
+            // the time spent recording must not be caught up
+            m_realTimeSynchronizer.restart();
+        }
     }
     else
     {
-        // Initialize recorder with default parameters
-        const int width = std::max(1, m_viewPortWidth);
-        const int height = std::max(1, m_viewPortHeight);
-        const unsigned int framerate = 60;
-        const unsigned int bitrate = 2000000;
-        const std::string codecExtension = "mp4";
-        const std::string codecName = "yuv420p";
-        
-        if(initRecorder(width, height, framerate, bitrate, codecExtension, codecName))
+        const RecordingProfile profile = getRecordingProfile();
+        unsigned int framerate = profile.framerate;
+
+        // the frames are scaled to the size of the video on the GPU, so that only the scaled frames are read back
+        const sofa::type::Vec2i profileSize = profile.getVideoSize(std::max(1, m_viewPortWidth), std::max(1, m_viewPortHeight));
+
+        // convert the frames on the GPU if possible: 1.5 bytes per pixel are read back instead of 4, and ffmpeg only encodes them
+        const bool isImageSequence = m_imageSequenceSettings.enabled;
+        m_videoFrameFormat = (!isImageSequence && m_bVideoGPUConversion && profile.pixelFormat == "yuv420p" && m_guiEngine->initYUV420Readback()) ? PixelFormat::YUV420 : PixelFormat::RGBA;
+        m_videoSize = (m_videoFrameFormat == PixelFormat::YUV420) ? YUV420Converter::getImageSize(profileSize[0], profileSize[1]) : profileSize;
+
+        // offline: one second of video per second of simulated time
+        const double offlineFrameDuration = (m_offlineRecordingSteps > 0) ? m_offlineRecordingSteps * this->groot->getDt() : m_offlineRecordingTimeStep;
+        const bool isOffline = isOfflineRecordingEnabled() && offlineFrameDuration > 0.0;
+        if (isOffline)
+        {
+            framerate = static_cast<unsigned int>(std::clamp(std::lround(1.0 / offlineFrameDuration), 1L, 1000L));
+        }
+
+        const bool isInitialized = isImageSequence ? initImageSequence()
+                                                   : initRecorder(m_videoSize[0], m_videoSize[1], framerate, profile);
+        if(isInitialized)
         {
+            m_bRecordingImageSequence = isImageSequence;
+            m_guiEngine->discardPendingFrameBufferPixels();
+
+            // every frame of an offline recording is encoded, the steps wait for the encoder if needed
+            m_bOfflineRecording = isOffline;
+            if (m_bOfflineRecording)
+            {
+                m_queuePolicyBeforeOfflineRecording = m_videoEncoder.getQueuePolicy();
+                m_videoEncoder.setQueuePolicy(VideoEncoderThread::QueuePolicy::Block);
+                m_nextRecordedFrameTime = this->groot->getTime() + m_offlineRecordingTimeStep;
+                msg_info("SofaGLFWBaseGUI") << "Offline recording: one frame every "
+                                            << (m_offlineRecordingSteps > 0 ? std::to_string(m_offlineRecordingSteps) + " steps" : std::to_string(m_offlineRecordingTimeStep) + " s")
+                                            << ", " << framerate << " frames per second";
+            }
+
+            m_videoEncoder.start([this, imageSequence = m_imageSequenceSettings](const PixelFramePtr& frame)
+            {
+                if (m_bRecordingImageSequence)
+                {
+                    // the images are compressed in parallel: this thread only numbers them, in order
+                    std::ostringstream fileName;
+                    fileName << m_imageSequenceBaseName << "_" << std::setfill('0') << std::setw(4) << m_imageSequenceCounter++ << "." << imageSequence.format;
+                    m_imageSequenceWriter.push(frame, (m_imageSequenceDirectory / fileName.str()).string(), imageSequence.compressionLevel);
+                }
+                else if (m_bRecordingThroughPipe)
+                {
+                    m_videoPipe.write(frame->data, frame->getNbBytes());
+                }
+                else
+                {
+                    // the recorder only reads the pixels, which are mapped read-only
+                    m_videoRecorderFFMPEG.addFrame(const_cast<std::uint8_t*>(frame->data), frame->size[0], frame->size[1]);
+                }
+            });
             m_bVideoRecording = true;
-            msg_info("SofaGLFWBaseGUI") << "Start recording";
+            msg_info("SofaGLFWBaseGUI") << "Start recording (profile '" << profile.name << "', " << m_videoSize[0] << "x" << m_videoSize[1] << ")";
         }
         else
         {
@@ -1222,24 +1993,184 @@ void SofaGLFWBaseGUI::toggleVideoRecording()
     }
 }
 
-bool SofaGLFWBaseGUI::initRecorder(int width, int height, unsigned int framerate, unsigned int bitrate, const std::string& codecExtension, const std::string& codecName)
+void SofaGLFWBaseGUI::startFrameStream(const FrameStreamSettings& settings)
 {
-    // Validate parameters
-    if (width <= 0 || height <= 0)
+    stopFrameStream();
+    m_frameStreamSettings = settings;
+    m_bFrameStreamRequested = true;
+}
+
+void SofaGLFWBaseGUI::stopFrameStream()
+{
+    if (m_framePublisher.isOpen())
     {
-        msg_error("SofaGLFWBaseGUI") << "Invalid video dimensions: " << width << "x" << height;
+        msg_info("SofaGLFWBaseGUI") << "End of the frame stream " << m_framePublisher.getName() << ": " << m_framePublisher.getNbPublishedFrames() << " frames published";
+        m_framePublisher.close();
+    }
+    m_bFrameStreamRequested = false;
+}
+
+bool SofaGLFWBaseGUI::openFrameStream()
+{
+    // the size of the frames is fixed for the lifetime of the stream, the frames are scaled on the GPU if the viewport is resized
+    const auto& requestedSize = m_frameStreamSettings.size;
+    m_frameStreamSize = (requestedSize[0] > 0 && requestedSize[1] > 0) ? requestedSize
+                                                                       : sofa::type::Vec2i(std::max(1, m_viewPortWidth), std::max(1, m_viewPortHeight));
+
+    if (!m_framePublisher.open(m_frameStreamSettings.name, m_frameStreamSettings.nbSlots, PixelFrame::getNbBytes(m_frameStreamSize, PixelFormat::RGBA)))
+    {
+        m_bFrameStreamRequested = false;
+        return false;
+    }
+
+    // the ring may hold frames of another size
+    if (!m_bVideoRecording)
+    {
+        m_guiEngine->discardPendingFrameBufferPixels();
+    }
+    return true;
+}
+
+void SofaGLFWBaseGUI::requestTiledScreenshot(const std::string& fileName, int width, int height)
+{
+    if (width <= 0 || height < 0)
+    {
+        msg_error("SofaGLFWBaseGUI") << "Invalid size of the poster " << fileName << ": " << width << "x" << height;
+        return;
+    }
+    m_tiledScreenshotRequest = TiledScreenshotRequest{ fileName, width, height };
+}
+
+bool SofaGLFWBaseGUI::saveTiledScreenshot(SofaGLFWWindow* sofaGlfwWindow, const TiledScreenshotRequest& request)
+{
+    const int width = request.width;
+    const int height = request.height > 0 ? request.height
+                                          : std::max(1, static_cast<int>(std::lround(static_cast<double>(width) * m_vparams->viewport()[3] / std::max(1, m_vparams->viewport()[2]))));
+
+    const auto drawTile = [this, sofaGlfwWindow, width, height](int x, int y, int tileWidth, int tileHeight)
+    {
+        sofaGlfwWindow->drawTile(this->groot, m_vparams, width, height, x, y, tileWidth, tileHeight);
+    };
+
+    const auto start = std::chrono::steady_clock::now();
+    bool saved = false;
+    const std::string& fileName = request.fileName;
+    if (std::filesystem::path(fileName).extension() == ".qoi")
+    {
+        // the encoded bands are written as they come: only one band of the image is in memory
+        std::ofstream file(fileName, std::ios::binary);
+        if (!file)
+        {
+            msg_error("SofaGLFWBaseGUI") << "Cannot open " << fileName;
+            return false;
+        }
+
+        QOIImage::Encoder encoder(width, height);
+        const auto writeBand = [&file, &encoder](const std::uint8_t* pixels, int nbRows)
+        {
+            encoder.addRows(pixels, nbRows, true);
+            file.write(reinterpret_cast<const char*>(encoder.getData().data()), static_cast<std::streamsize>(encoder.getData().size()));
+            encoder.getData().clear();
+            return static_cast<bool>(file);
+        };
+        if (m_tiledRenderer.render(width, height, drawTile, writeBand))
+        {
+            encoder.finish();
+            file.write(reinterpret_cast<const char*>(encoder.getData().data()), static_cast<std::streamsize>(encoder.getData().size()));
+            saved = static_cast<bool>(file);
+        }
+    }
+    else
+    {
+        const std::size_t rowSize = static_cast<std::size_t>(width) * 4;
+        if (static_cast<std::size_t>(height) * rowSize > (std::size_t(1) << 30))
+        {
+            msg_warning("SofaGLFWBaseGUI") << "The poster " << fileName << " (" << width << "x" << height
+                                           << ") is encoded in memory: save it as .qoi to keep the memory bounded.";
+        }
+
+        // the bands come from the top of the image, the rows of the image go from the bottom
+        sofa::helper::io::STBImage image;
+        image.init(static_cast<unsigned int>(width), static_cast<unsigned int>(height), 1, 1,
+                   sofa::helper::io::Image::DataType::UINT32, sofa::helper::io::Image::ChannelFormat::RGBA);
+        int nbRemainingRows = height;
+        const auto writeBand = [&image, &nbRemainingRows, rowSize](const std::uint8_t* pixels, int nbRows)
+        {
+            nbRemainingRows -= nbRows;
+            std::memcpy(image.getPixels() + rowSize * static_cast<std::size_t>(nbRemainingRows), pixels, rowSize * static_cast<std::size_t>(nbRows));
+            return true;
+        };
+        saved = m_tiledRenderer.render(width, height, drawTile, writeBand) && image.save(fileName);
+    }
+
+    if (!saved)
+    {
+        msg_error("SofaGLFWBaseGUI") << "Failed to save the poster " << fileName;
+        return false;
+    }
+    msg_info("SofaGLFWBaseGUI") << "Poster saved: " << fileName << " (" << width << "x" << height << ") in "
+                                << std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() << " s";
+    return true;
+}
+
+bool SofaGLFWBaseGUI::initImageSequence()
+{
+    static constexpr std::array<const char*, 6> supportedFormats { "png", "jpg", "jpeg", "bmp", "tga", "qoi" };
+    if (std::find(supportedFormats.begin(), supportedFormats.end(), m_imageSequenceSettings.format) == supportedFormats.end())
+    {
+        msg_error("SofaGLFWBaseGUI") << "Unsupported image format '" << m_imageSequenceSettings.format << "'. Supported formats: png, jpg, bmp, tga, qoi.";
         return false;
     }
 
-    bool res = true;
-    std::string ffmpeg_exec_path = "";
+    // named after the scene, as the screenshots, in a new directory for each sequence
+    const std::string sceneFileName = getSceneFileName();
+    m_imageSequenceBaseName = sceneFileName.empty() ? "sofa" : std::filesystem::path(sceneFileName).stem().string();
+    for (unsigned int index = 0; ; ++index)
+    {
+        std::ostringstream directoryName;
+        directoryName << m_imageSequenceBaseName << "_images_" << std::setfill('0') << std::setw(4) << index;
+        m_imageSequenceDirectory = std::filesystem::current_path() / directoryName.str();
+        if (!std::filesystem::exists(m_imageSequenceDirectory))
+        {
+            break;
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::create_directories(m_imageSequenceDirectory, error);
+    if (error)
+    {
+        msg_error("SofaGLFWBaseGUI") << "Cannot create the directory " << m_imageSequenceDirectory.string() << ": " << error.message();
+        return false;
+    }
+
+    // a few images per thread in the queue keep the threads busy, beyond that the encoder queue policy applies
+    const std::size_t nbThreads = (m_imageSequenceSettings.nbThreads > 0) ? m_imageSequenceSettings.nbThreads : std::max(1u, std::thread::hardware_concurrency());
+    m_imageSequenceWriter.setNbThreads(nbThreads);
+    m_imageSequenceWriter.setQueueCapacity(2 * nbThreads);
+    m_imageSequenceWriter.setLogEachImage(false);
+    m_imageSequenceCounter = 0;
+
+    msg_info("SofaGLFWBaseGUI") << "Recording " << m_imageSequenceSettings.format << " images into " << m_imageSequenceDirectory.string()
+                                << " (" << nbThreads << " threads)";
+    return true;
+}
+
+void SofaGLFWBaseGUI::loadRecorderSettings()
+{
+    if (m_bRecorderSettingsLoaded)
+    {
+        return;
+    }
+    m_bRecorderSettingsLoaded = true;
+
     const std::string ffmpegIniFilePath = sofa::helper::Utils::getSofaPathTo("etc/SofaGLFW.ini");
     std::map<std::string, std::string> iniFileValues = sofa::helper::Utils::readBasicIniFile(ffmpegIniFilePath);
     if (iniFileValues.find("FFMPEG_EXEC_PATH") != iniFileValues.end())
     {
         // get absolute path of FFMPEG executable
-        ffmpeg_exec_path = sofa::helper::system::SetDirectory::GetRelativeFromProcess(iniFileValues["FFMPEG_EXEC_PATH"].c_str());
-        msg_info("SofaGLFWBaseGUI") << " The file " << ffmpegIniFilePath << " points to " << ffmpeg_exec_path << " for the ffmpeg executable.";
+        m_ffmpegExecPath = sofa::helper::system::SetDirectory::GetRelativeFromProcess(iniFileValues["FFMPEG_EXEC_PATH"].c_str());
+        msg_info("SofaGLFWBaseGUI") << " The file " << ffmpegIniFilePath << " points to " << m_ffmpegExecPath << " for the ffmpeg executable.";
     }
     else
     {
@@ -1247,11 +2178,64 @@ bool SofaGLFWBaseGUI::initRecorder(int width, int height, unsigned int framerate
         " The initialization of the FFMPEG video recorder will likely fail. To fix this, provide a valid path to the ffmpeg executable inside this file using the syntax \"FFMPEG_EXEC_PATH=/usr/bin/ffmpeg\".";
     }
 
-    const std::string videoFilename = m_videoRecorderFFMPEG.findFilename(framerate, bitrate / 1024, codecExtension);
+    m_recordingProfiles = RecordingProfile::load(iniFileValues);
+}
+
+const std::vector<RecordingProfile>& SofaGLFWBaseGUI::getRecordingProfiles()
+{
+    loadRecorderSettings();
+    return m_recordingProfiles;
+}
+
+bool SofaGLFWBaseGUI::setRecordingProfile(const std::string& name)
+{
+    const auto& profiles = getRecordingProfiles();
+    if (std::none_of(profiles.begin(), profiles.end(), [&name](const RecordingProfile& profile) { return profile.name == name; }))
+    {
+        std::string names;
+        for (const auto& profile : profiles)
+        {
+            names += (names.empty() ? "" : ", ") + profile.name;
+        }
+        msg_error("SofaGLFWBaseGUI") << "Unknown recording profile '" << name << "'. Available profiles: " << names;
+        return false;
+    }
+
+    m_recordingProfileName = name;
+    return true;
+}
 
-    res = m_videoRecorderFFMPEG.init(ffmpeg_exec_path, videoFilename, width, height, framerate, bitrate, codecName);
+const RecordingProfile& SofaGLFWBaseGUI::getRecordingProfile()
+{
+    const auto& profiles = getRecordingProfiles();
+    const auto it = std::find_if(profiles.begin(), profiles.end(), [this](const RecordingProfile& profile) { return profile.name == m_recordingProfileName; });
+
+    // the built-in profiles come first, the first one records the viewport as is
+    return (it != profiles.end()) ? *it : profiles.front();
+}
+
+bool SofaGLFWBaseGUI::initRecorder(int width, int height, unsigned int framerate, const RecordingProfile& profile)
+{
+    // Validate parameters
+    if (width <= 0 || height <= 0)
+    {
+        msg_error("SofaGLFWBaseGUI") << "Invalid video dimensions: " << width << "x" << height;
+        return false;
+    }
+
+    loadRecorderSettings();
+
+    const std::string videoFilename = m_videoRecorderFFMPEG.findFilename(framerate, profile.bitrate / 1024, profile.extension);
+
+    // VideoRecorderFFMPEG neither accepts converted frames nor chooses the encoder
+    m_bRecordingThroughPipe = (m_videoFrameFormat == PixelFormat::YUV420) || !profile.codec.empty();
+    if (m_bRecordingThroughPipe)
+    {
+        const std::string inputPixelFormat = (m_videoFrameFormat == PixelFormat::YUV420) ? "yuv420p" : "rgba";
+        return m_videoPipe.open(m_ffmpegExecPath, videoFilename, width, height, framerate, profile.bitrate, inputPixelFormat, profile.pixelFormat, profile.codec);
+    }
 
-    return res;
+    return m_videoRecorderFFMPEG.init(m_ffmpegExecPath, videoFilename, width, height, framerate, profile.bitrate, profile.pixelFormat);
 }
 
 
@@ -28,9 +28,30 @@
 #include <SofaGLFW/BaseGUIEngine.h>
 #include <SofaGLFW/NullGUIEngine.h>
 #include <sofa/gui/common/BaseViewer.h>
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <functional>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
 
 #include <SofaGLFW/SofaGLFWMouseManager.h>
+#include <SofaGLFW/SimulationThread.h>
+#include <SofaGLFW/RealTimeSynchronizer.h>
+#include <SofaGLFW/FrameTimings.h>
+#include <SofaGLFW/InputEventQueue.h>
+#include <SofaGLFW/AsyncSceneLoader.h>
+#include <SofaGLFW/SimulationSnapshot.h>
+#include <SofaGLFW/SimulationTimeline.h>
+#include <SofaGLFW/SteppingController.h>
+#include <SofaGLFW/VideoEncoderThread.h>
+#include <SofaGLFW/FFMPEGVideoPipe.h>
+#include <SofaGLFW/RecordingProfile.h>
+#include <SofaGLFW/SharedMemoryFrameStream.h>
+#include <SofaGLFW/ScreenshotWriter.h>
+#include <SofaGLFW/TiledRenderer.h>
 #include <sofa/gl/VideoRecorderFFMPEG.h>
 
 struct GLFWwindow;
@@ -51,10 +72,107 @@ public:
 
     bool init(int nbMSAASamples = 0);
     void setErrorCallback() const;
+
+    /**
+     * Opt-in OpenGL 3.3 core profile context, without the fixed-function pipeline: the viewer sets no legacy state,
+     * and gives the camera and the light to the shaders through a uniform buffer (see ViewerUniformBuffer).
+     * The components drawing with the legacy pipeline (DrawToolGL, OglModel, ...) do not draw in this mode.
+     * Taken into account when the first window is created. Falls back to the legacy (compatibility) profile if the
+     * GUI engine or the driver does not support it.
+     */
+    void setCoreProfile(bool enabled) { m_bCoreProfileRequested = enabled; }
+    bool isCoreProfile() const { return m_bCoreProfile; }
     void setSimulation(sofa::simulation::NodeSPtr groot, const std::string& filename = std::string());
     void setSimulationIsRunning(bool running);
     bool simulationIsRunning() const;
 
+    /**
+     * Load a scene file and initialize it (initRoot) on a background thread, while the current scene is still displayed (paused).
+     * The new root replaces the current one at the beginning of a later iteration of runLoop, after its OpenGL initialization.
+     * Returns false if a scene is already being loaded.
+     */
+    bool loadSceneAsync(const std::string& fileName, bool reload = false);
+    const AsyncSceneLoader& getSceneLoader() const { return m_sceneLoader; }
+
+    /**
+     * Restore the state of the scene captured right after its initialization, without reloading the file.
+     * Returns false if no state was captured for the current root.
+     */
+    bool resetSimulation();
+    const SimulationSnapshot& getInitialState() const { return m_initialState; }
+
+    /// History of the last steps (disabled until it is given a memory budget). Modify it while holding acquireScene().
+    SimulationTimeline& getTimeline() { return m_timeline; }
+    const SimulationTimeline& getTimeline() const { return m_timeline; }
+
+    /// Pause the simulation and put it back in the state of a recorded step.
+    bool restoreTimelineFrame(std::size_t frameIndex);
+
+    /**
+     * Stepping commands (step N, run until a time or a predicate, run for a wall-clock duration), computed by the
+     * main loop whether the simulation is running or paused. Their steps are batched: the visual models are updated
+     * and the scene drawn only every s_steppingSliceDuration seconds, and at the end of the command.
+     */
+    SteppingController& getSteppingController() { return m_steppingController; }
+    const SteppingController& getSteppingController() const { return m_steppingController; }
+
+    /// Run the main loop until the stepping commands are done (batch mode). Returns the number of steps computed.
+    std::size_t runSteppingCommands();
+
+    /**
+     * Run the simulation steps on a dedicated thread instead of the render loop.
+     * The render loop never waits for a step: it draws the latest complete step between two steps, and while a step
+     * is computed it keeps handling the events, the window showing its last frame.
+     * Code modifying the scene from the render thread must hold acquireScene(), which waits for the end of the step,
+     * or go through runInScene() (mouse events).
+     */
+    void setSimulationThreaded(bool threaded) { m_bSimulationThreaded = threaded; }
+    bool isSimulationThreaded() const { return m_bSimulationThreaded; }
+    const SimulationThread& getSimulationThread() const { return m_simulationThread; }
+
+    /// Lock the scene against the simulation thread. Does nothing if the simulation is not threaded.
+    SimulationThread::SceneLock acquireScene();
+
+    /// Run a task reading or modifying the scene (e.g. a mouse event) without waiting for the step in progress:
+    /// right away if the simulation is not threaded, otherwise on the simulation thread before its next step.
+    void runInScene(std::function<void()> task);
+
+    /// Number of simulation steps computed before each displayed frame. Only the last one updates the visual models.
+    void setNbStepsPerFrame(unsigned int nbSteps) { m_nbStepsPerFrame = std::max(1u, nbSteps); }
+    unsigned int getNbStepsPerFrame() const { return m_nbStepsPerFrame; }
+
+    /// Maximum number of displayed frames per second (0: no limit). The simulation keeps stepping between two frames.
+    void setMaxFrameRate(double frameRate) { m_maxFrameRate = std::max(0.0, frameRate); }
+    double getMaxFrameRate() const { return m_maxFrameRate; }
+
+    /**
+     * Pace the simulation on the wall-clock time: a step is computed only when it is due, and the
+     * synchronizer catch-up policy decides how many steps are computed when the simulation is late.
+     * Replaces the number of steps per frame while enabled.
+     */
+    void setRealTime(bool realTime);
+    bool isRealTime() const { return m_bRealTime; }
+    RealTimeSynchronizer& getRealTimeSynchronizer() { return m_realTimeSynchronizer; }
+    const RealTimeSynchronizer& getRealTimeSynchronizer() const { return m_realTimeSynchronizer; }
+
+    /**
+     * While the simulation is paused, draw only when something changed (input events, camera, redraw())
+     * and wait for the events instead of polling them, so that a paused viewer does not keep a CPU core busy.
+     * The Data are not tracked: a Data modified outside of the GUI (e.g. by a script) is only drawn
+     * by the refresh done every s_idleRefreshPeriod.
+     */
+    void setIdleWhenPaused(bool idle) { m_bIdleWhenPaused = idle; }
+    bool isIdleWhenPaused() const { return m_bIdleWhenPaused; }
+    bool isIdle() const { return m_bIsIdle; }
+
+    using FrameTimings = sofaglfw::FrameTimings;
+
+    /// Timings of the phases of the last iterations of runLoop. Can be read from any thread.
+    const FrameTimingsHistory& getFrameTimingsHistory() const { return m_frameTimingsHistory; }
+
+    /// Called at the end of each iteration of runLoop, e.g. to profile the main loop.
+    void setFrameTimingsCallback(std::function<void(const FrameTimings&)> callback) { m_frameTimingsCallback = std::move(callback); }
+
     bool createWindow(int width, int height, const char* title, bool fullscreenAtStartup = false);
     void destroyWindow();
     void initVisual();
@@ -65,6 +183,8 @@ public:
     void setWindowWidth(int width) { m_windowWidth = width; }
     int getWindowHeight() const { return m_windowHeight; }
     void setWindowHeight(int height) { m_windowHeight = height; }
+    /// Size of the area where the scene is drawn (and recorded).
+    sofa::type::Vec2i getViewPortSize() const { return { m_viewPortWidth, m_viewPortHeight }; }
     void resizeWindow(int width, int height);
     bool centerWindow(GLFWwindow* window = nullptr);
     void updateViewportPosition(float viewportPositionX, float viewportPositionY) ;
@@ -83,6 +203,7 @@ public:
     void switchFullScreen(GLFWwindow* glfwWindow = nullptr, unsigned int screenID = 0);
     void setWindowBackgroundColor(const RGBAColor& newColor, unsigned int windowID = 0);
     void setWindowBackgroundImage(const std::string& imageFileName, unsigned int windowID = 0);
+    void setWindowBackgroundGradient(const RGBAColor& bottomColor, const RGBAColor& topColor, unsigned int windowID = 0);
     void setWindowTitle(GLFWwindow* window, const char* title);
     
     virtual void setBackgroundColour(float r, float g, float b) override
@@ -115,13 +236,82 @@ public:
     void moveRayPickInteractor(int eventX, int eventY) override ;
     
     void toggleVideoRecording();
-    bool initRecorder(int width, int height, unsigned int framerate, unsigned int bitrate, const std::string& codecExtension, const std::string& codecName);
+    /// Open the video of the given size, encoded with the bitrate, container, codec and pixel format of the profile.
+    bool initRecorder(int width, int height, unsigned int framerate, const RecordingProfile& profile);
+
+    /// The built-in recording profiles, and the ones declared in etc/SofaGLFW.ini (read once).
+    const std::vector<RecordingProfile>& getRecordingProfiles();
+    /// Select the profile of the next recordings. Returns false if there is no profile of this name.
+    bool setRecordingProfile(const std::string& name);
+    const RecordingProfile& getRecordingProfile();
 
     bool isVideoRecording() const
     {
         return m_bVideoRecording;
     }
 
+    /// The recorded frames are encoded on this thread. Set its queue policy and capacity before starting a recording.
+    VideoEncoderThread& getVideoEncoder() { return m_videoEncoder; }
+    const VideoEncoderThread& getVideoEncoder() const { return m_videoEncoder; }
+
+    /// If true (default), yuv420p videos are recorded from frames converted on the GPU, when the GUI engine supports it.
+    void setVideoGPUConversion(bool enabled) { m_bVideoGPUConversion = enabled; }
+    bool getVideoGPUConversion() const { return m_bVideoGPUConversion; }
+
+    /**
+     * Offline recording: the video gets exactly one frame every nbSteps simulation steps, or every timeStep of
+     * simulated time, and the steps are computed as fast as possible instead of in real time. The frame rate of
+     * the video follows the simulated time, so that the video is the same whatever the load of the machine.
+     * Taken into account when a recording starts. 0 (default) records a frame each time the scene is drawn.
+     */
+    void setOfflineRecordingSteps(unsigned int nbSteps) { m_offlineRecordingSteps = nbSteps; m_offlineRecordingTimeStep = 0.0; }
+    void setOfflineRecordingTimeStep(double timeStep) { m_offlineRecordingTimeStep = std::max(0.0, timeStep); m_offlineRecordingSteps = 0; }
+    unsigned int getOfflineRecordingSteps() const { return m_offlineRecordingSteps; }
+    double getOfflineRecordingTimeStep() const { return m_offlineRecordingTimeStep; }
+    bool isOfflineRecordingEnabled() const { return m_offlineRecordingSteps > 0 || m_offlineRecordingTimeStep > 0.0; }
+
+    /**
+     * Image sequence: a recording writes every frame as a numbered image (<scene>_0000.png, ...) into a new
+     * directory, instead of a video. The images are compressed in parallel by a pool of worker threads.
+     * Taken into account when a recording starts.
+     */
+    struct ImageSequenceSettings
+    {
+        bool enabled { false };
+        std::string format { "png" };   ///< png, jpg, bmp, tga or qoi (lossless, fast)
+        int compressionLevel { -1 };    ///< zlib level (0-9) for png, quality (1-100) for jpg, -1 for the default
+        std::size_t nbThreads { 0 };    ///< 0: one per hardware thread
+    };
+    void setImageSequenceSettings(const ImageSequenceSettings& settings) { m_imageSequenceSettings = settings; }
+    const ImageSequenceSettings& getImageSequenceSettings() const { return m_imageSequenceSettings; }
+
+    /**
+     * Frame stream: the frames drawn are published into a shared-memory ring, read without copy by other local
+     * processes (see SharedMemoryFrameReader). While a video is recorded, the recorded frames are published instead,
+     * if they fit in the slots of the stream.
+     */
+    struct FrameStreamSettings
+    {
+        std::string name { "/sofaglfw_frames" };
+        std::size_t nbSlots { 3 };
+        sofa::type::Vec2i size { 0, 0 };  ///< size of the published frames (RGBA), {0, 0} for the viewport when the stream starts
+    };
+    /// The stream is created with the next frame drawn.
+    void startFrameStream(const FrameStreamSettings& settings = {});
+    void stopFrameStream();
+    bool isFrameStreaming() const { return m_bFrameStreamRequested; }
+
+    /**
+     * Poster: a screenshot of the scene larger than the frame buffers of the driver, rendered tile by tile after
+     * the next frame (see TiledRenderer). A .qoi file is written band by band, so its size is only bounded by the
+     * disk; the other formats need the whole image in memory. A height of 0 keeps the aspect ratio of the viewport.
+     */
+    void requestTiledScreenshot(const std::string& fileName, int width, int height = 0);
+    bool isTiledScreenshotPending() const { return m_tiledScreenshotRequest.has_value(); }
+
+    /// Start recording a video once the first frame is drawn (e.g. from the command line, before the window has a size).
+    void setVideoRecordingAtStartup(bool enabled) { m_bVideoRecordingAtStartup = enabled; }
+
     static void triggerSceneAxis(sofa::simulation::NodeSPtr groot);
 
 private:
@@ -140,9 +330,25 @@ private:
     static int handleArrowKeys(int key);
     static void translateToViewportCoordinates (SofaGLFWBaseGUI* gui,double xpos, double ypos);
     static void content_scale_callback(GLFWwindow* window, float xscale, float yscale);
+    static void window_refresh_callback(GLFWwindow* window);
+    static void requestRedraw(GLFWwindow* window);
+
+    // Mouse events are queued by the callbacks, and handled once per frame by processInputEvents
+    void pushInputEvent(const InputEvent& event);
+    void processInputEvents();
+    void handleMouseButton(const InputEvent& event);
+    void handleCursorPosition(const InputEvent& event);
+    void handleScroll(const InputEvent& event);
 
     void makeCurrentContext(GLFWwindow* sofaWindow);
-    void runStep();
+    std::size_t runStep(bool updateVisual = true, std::size_t maxNbSteps = 0);
+    /// Run the tasks queued by runInScene, while holding the scene
+    void runSceneTasks();
+    // how long the simulation thread can sleep when runStep computed nothing (infinity: until a change is notified)
+    double getIdleTime() const;
+    bool isFrameDue();
+    bool updateIdleState();
+    void finishSceneLoading();
 
     inline static std::map<GLFWwindow*, SofaGLFWWindow*> s_mapWindows{};
     inline static std::map<GLFWwindow*, SofaGLFWBaseGUI*> s_mapGUIs{};
@@ -150,6 +356,10 @@ private:
 
     bool m_bGlfwIsInitialized{ false };
     bool m_bGlewIsInitialized{ false };
+    bool m_bCoreProfileRequested{ false };
+    bool m_bCoreProfile{ false };
+    GLFWwindow* createGLFWWindow(int width, int height, const char* title, bool fullscreenAtStartup);
+    static void setCoreProfileWindowHints(bool coreProfile);
 
     sofa::gl::DrawToolGL* m_glDrawTool{ nullptr };
     sofa::core::visual::VisualParams* m_vparams{ nullptr };
@@ -169,9 +379,94 @@ private:
     std::size_t m_backgroundID{0};
 
     std::shared_ptr<BaseGUIEngine> m_guiEngine;
+    InputEventQueue m_inputEvents;
+    AsyncSceneLoader m_sceneLoader;
+    SimulationSnapshot m_initialState;
+    SimulationTimeline m_timeline;
+    SteppingController m_steppingController;
+    bool m_bQuitWhenSteppingDone {false};
+    /// maximum wall-clock time spent on the steps of a command between two frames
+    static constexpr double s_steppingSliceDuration { 0.1 };
     
     bool m_bVideoRecording {false};
     sofa::gl::VideoRecorderFFMPEG m_videoRecorderFFMPEG;
+    /// receives the frames converted on the GPU, which VideoRecorderFFMPEG does not accept
+    FFMPEGVideoPipe m_videoPipe;
+    VideoEncoderThread m_videoEncoder;
+    bool m_bVideoGPUConversion {true};
+    PixelFormat m_videoFrameFormat {PixelFormat::RGBA};
+    sofa::type::Vec2i m_videoSize {0, 0};
+    /// the current recording goes through m_videoPipe rather than m_videoRecorderFFMPEG
+    bool m_bRecordingThroughPipe {false};
+    bool m_bVideoRecordingAtStartup {false};
+
+    // etc/SofaGLFW.ini is read on the first recording or access to the profiles
+    void loadRecorderSettings();
+    bool m_bRecorderSettingsLoaded {false};
+    std::string m_ffmpegExecPath;
+    std::vector<RecordingProfile> m_recordingProfiles;
+    std::string m_recordingProfileName {"viewport"};
+
+    bool initImageSequence();
+    ImageSequenceSettings m_imageSequenceSettings;
+    /// the current recording writes images
+    bool m_bRecordingImageSequence {false};
+    ScreenshotWriter m_imageSequenceWriter;
+    std::filesystem::path m_imageSequenceDirectory;
+    std::string m_imageSequenceBaseName;
+    std::size_t m_imageSequenceCounter {0};
+
+    bool openFrameStream();
+    FrameStreamSettings m_frameStreamSettings;
+    bool m_bFrameStreamRequested {false};
+    SharedMemoryFramePublisher m_framePublisher;
+    sofa::type::Vec2i m_frameStreamSize {0, 0};
+
+    struct TiledScreenshotRequest
+    {
+        std::string fileName;
+        int width {0};
+        int height {0};
+    };
+    bool saveTiledScreenshot(SofaGLFWWindow* sofaGlfwWindow, const TiledScreenshotRequest& request);
+    std::optional<TiledScreenshotRequest> m_tiledScreenshotRequest;
+    TiledRenderer m_tiledRenderer;
+
+    unsigned int m_offlineRecordingSteps {0};
+    double m_offlineRecordingTimeStep {0.0};
+    /// the current recording is offline
+    bool m_bOfflineRecording {false};
+    double m_nextRecordedFrameTime {0.0};
+    VideoEncoderThread::QueuePolicy m_queuePolicyBeforeOfflineRecording {VideoEncoderThread::QueuePolicy::Block};
+
+    bool m_bSimulationThreaded {false};
+    SimulationThread m_simulationThread;
+    std::mutex m_sceneTasksMutex;
+    std::vector<std::function<void()>> m_sceneTasks;
+
+    unsigned int m_nbStepsPerFrame {1};
+    double m_maxFrameRate {0.0};
+    double m_lastFrameTime {0.0};
+
+    std::atomic<bool> m_bRealTime {false};
+    bool m_bVisualUpdatePending {false}; ///< steps computed since the last update of the visual models
+    RealTimeSynchronizer m_realTimeSynchronizer;
+
+    /// number of frames drawn after a change, so that the GUI engine can settle (hovering, animations, ...)
+    static constexpr int s_nbRedrawsPerChange { 3 };
+    /// period of the redraws while idle, for the changes which cannot be tracked
+    static constexpr double s_idleRefreshPeriod { 0.5 };
+
+    FrameTimingsHistory m_frameTimingsHistory;
+    std::uint64_t m_frameIndex {0};
+    std::function<void(const FrameTimings&)> m_frameTimingsCallback;
+
+    bool m_bIdleWhenPaused {true};
+    bool m_bIsIdle {false};
+    std::atomic<int> m_nbPendingRedraws {s_nbRedrawsPerChange};
+    double m_lastIdleRefreshTime {0.0};
+    sofa::component::visual::BaseCamera::Vec3 m_lastCameraPosition;
+    sofa::component::visual::BaseCamera::Quat m_lastCameraOrientation;
 };
 
 } // namespace sofaglfw
@@ -20,6 +20,7 @@
 * Contact information: contact@sofa-framework.org                             *
 ******************************************************************************/
 #include <SofaGLFW/SofaGLFWWindow.h>
+#include <SofaGLFW/TiledRenderer.h>
 #include <sofa/gui/common/BaseViewer.h>
 #include <sofa/gui/common/BaseGUI.h>
 #include <sofa/gui/common/PickHandler.h>
@@ -36,6 +37,7 @@
 #include <sofa/gl/gl.h>
 #include <sofa/gl/Texture.h>
 
+#include <algorithm>
 #include <ranges>
 
 using namespace sofa;
@@ -50,8 +52,11 @@ SofaGLFWWindow::SofaGLFWWindow(GLFWwindow* glfwWindow, component::visual::BaseCa
 
 void SofaGLFWWindow::close()
 {
-    glfwDestroyWindow(m_glfwWindow);
-    
+    // the GPU resources belong to the context of the window
+    glfwMakeContextCurrent(m_glfwWindow);
+    m_backgroundRenderer.release();
+    m_viewerUniforms.release();
+
     if(m_currentBackgroundTexture)
     {
         delete m_currentBackgroundTexture;
@@ -64,21 +69,56 @@ void SofaGLFWWindow::close()
     }
     
     m_backgrounds.clear();
+
+    glfwDestroyWindow(m_glfwWindow);
 }
 
 
 void SofaGLFWWindow::draw(simulation::NodeSPtr groot, core::visual::VisualParams* vparams)
 {
+    const int width = vparams->viewport()[2];
+    const int height = vparams->viewport()[3];
+    drawRegion(groot, vparams, width, height, 0, 0, width, height);
+}
+
+void SofaGLFWWindow::drawTile(simulation::NodeSPtr groot, core::visual::VisualParams* vparams,
+                              int imageWidth, int imageHeight, int x, int y, int width, int height)
+{
+    // the camera and the visual params describe the displayed view again once the tile is drawn
+    const auto viewport = vparams->viewport();
+    const int cameraWidth = m_currentCamera ? m_currentCamera->d_widthViewport.getValue() : 0;
+    const int cameraHeight = m_currentCamera ? m_currentCamera->d_heightViewport.getValue() : 0;
+
+    vparams->viewport() = { 0, 0, width, height };
+    drawRegion(groot, vparams, imageWidth, imageHeight, x, y, width, height);
+
+    vparams->viewport() = viewport;
+    if (m_currentCamera)
+    {
+        m_currentCamera->d_widthViewport.setValue(cameraWidth);
+        m_currentCamera->d_heightViewport.setValue(cameraHeight);
+        m_currentCamera->computeZ();
+    }
+}
+
+void SofaGLFWWindow::drawRegion(simulation::NodeSPtr groot, core::visual::VisualParams* vparams,
+                                int imageWidth, int imageHeight, int x, int y, int width, int height)
+{
+    glViewport(0, 0, width, height);
     glClearColor(m_backgroundColor.r(), m_backgroundColor.g(), m_backgroundColor.b(), m_backgroundColor.a());
     glClearDepth(1.0);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-    if (!m_currentBackgroundFilename.empty())
-        drawBackgroundImage();
+    // drawn right after the clear: the state it changes is set again for the scene below
+    if (updateBackgroundRenderer())
+        m_backgroundRenderer.draw(imageWidth, imageHeight, x, y, width, height);
     
-    glEnable(GL_LIGHTING);
     glEnable(GL_DEPTH_TEST);
-    glDisable(GL_COLOR_MATERIAL);
+    if (!m_bCoreProfile)
+    {
+        glEnable(GL_LIGHTING);
+        glDisable(GL_COLOR_MATERIAL);
+    }
 
     // draw the scene
     if (!m_currentCamera)
@@ -94,8 +134,8 @@ void SofaGLFWWindow::draw(simulation::NodeSPtr groot, core::visual::VisualParams
         m_currentCamera->setBoundingBox(vparams->sceneBBox().minBBox(), vparams->sceneBBox().maxBBox());
     }
     m_currentCamera->computeZ();
-    m_currentCamera->d_widthViewport.setValue(vparams->viewport()[2]);
-    m_currentCamera->d_heightViewport.setValue(vparams->viewport()[3]);
+    m_currentCamera->d_widthViewport.setValue(imageWidth);
+    m_currentCamera->d_heightViewport.setValue(imageHeight);
 
     // matrices
     double lastModelviewMatrix [16];
@@ -104,14 +144,29 @@ void SofaGLFWWindow::draw(simulation::NodeSPtr groot, core::visual::VisualParams
     m_currentCamera->getOpenGLProjectionMatrix(lastProjectionMatrix);
     m_currentCamera->getOpenGLModelViewMatrix(lastModelviewMatrix);
 
-    glViewport(0, 0, vparams->viewport()[2], vparams->viewport()[3]);
-    glMatrixMode(GL_PROJECTION);
-    glLoadIdentity();
-    glMultMatrixd(lastProjectionMatrix);
+    if (width != imageWidth || height != imageHeight)
+    {
+        double imageProjectionMatrix [16];
+        std::copy(std::begin(lastProjectionMatrix), std::end(lastProjectionMatrix), imageProjectionMatrix);
+        TiledRenderer::getTileProjectionMatrix(imageProjectionMatrix, imageWidth, imageHeight, x, y, width, height, lastProjectionMatrix);
+    }
 
-    glMatrixMode(GL_MODELVIEW);
-    glLoadIdentity();
-    glMultMatrixd(lastModelviewMatrix);
+    // without the matrix stacks of the legacy profile, the shaders read the camera from the uniform buffer
+    if (m_bCoreProfile)
+    {
+        if (m_viewerUniforms.init())
+            m_viewerUniforms.update(lastProjectionMatrix, lastModelviewMatrix, 0, 0, width, height);
+    }
+    else
+    {
+        glMatrixMode(GL_PROJECTION);
+        glLoadIdentity();
+        glMultMatrixd(lastProjectionMatrix);
+
+        glMatrixMode(GL_MODELVIEW);
+        glLoadIdentity();
+        glMultMatrixd(lastModelviewMatrix);
+    }
 
     // Update the visual params
     vparams->zNear() = m_currentCamera->getZNear();
@@ -127,6 +182,15 @@ void SofaGLFWWindow::setBackgroundColor(const RGBAColor& newColor)
 {
     m_backgroundColor = newColor;
     m_currentBackgroundFilename = "";
+    m_bBackgroundGradient = false;
+}
+
+void SofaGLFWWindow::setBackgroundGradient(const RGBAColor& bottomColor, const RGBAColor& topColor)
+{
+    m_backgroundGradientBottom = bottomColor;
+    m_backgroundGradientTop = topColor;
+    m_bBackgroundGradient = true;
+    m_currentBackgroundFilename = "";
 }
 
 
@@ -161,65 +225,30 @@ void SofaGLFWWindow::setBackgroundImage(const std::string& filename)
         }
     }
     m_currentBackgroundFilename = filename;
+    m_bBackgroundGradient = false;
 }
 
 
-void SofaGLFWWindow::drawBackgroundImage()
+bool SofaGLFWWindow::updateBackgroundRenderer()
 {
-    if(!m_backgrounds.contains(m_currentBackgroundFilename))
-        return;
+    if (!m_currentBackgroundFilename.empty())
+    {
+        const auto background = m_backgrounds.find(m_currentBackgroundFilename);
+        if (background == m_backgrounds.end() || !background->second.image || !background->second.texture)
+            return false;
 
-    glPushAttrib(GL_ALL_ATTRIB_BITS);
-    
-    glDisable(GL_LIGHTING);
-    
-    const auto& background = m_backgrounds[m_currentBackgroundFilename];
+        m_backgroundRenderer.setImage(background->second.texture->getId(), background->second.image->getWidth(), background->second.image->getHeight());
+    }
+    else if (m_bBackgroundGradient)
+    {
+        m_backgroundRenderer.setGradient(m_backgroundGradientBottom, m_backgroundGradientTop);
+    }
+    else
+    {
+        return false;
+    }
 
-    if(!background.image)
-        return;
-    
-    const int imageWidth = background.image->getWidth();
-    const int imageHeight = background.image->getHeight();
-    
-    int screenWidth = 0;
-    int screenHeight = 0;
-    
-    screenWidth = m_currentCamera->d_widthViewport.getValue();
-    screenHeight = m_currentCamera->d_heightViewport.getValue();
-        
-    glEnable(GL_TEXTURE_2D);
-    glDisable(GL_DEPTH_TEST);
-    glMatrixMode(GL_PROJECTION);
-    glPushMatrix();
-    glLoadIdentity();
-    glOrtho(-0.5, screenWidth, -0.5, screenHeight, -1.0, 1.0);
-    glMatrixMode(GL_MODELVIEW);
-    glPushMatrix();
-    glLoadIdentity();
-
-    background.texture->bind();
-
-    const double coordWidth = int(screenWidth / imageWidth) + 1;
-    const double coordHeight = int(screenHeight / imageHeight) + 1;
-
-    glColor3f(1.0f, 1.0f, 1.0f);
-    glBegin(GL_QUADS);
-    glTexCoord2d(0.0,            0.0);             glVertex3d( -imageWidth*coordWidth, -imageHeight*coordHeight, 0.0 );
-    glTexCoord2d(coordWidth*2.0, 0.0);             glVertex3d(  imageWidth*coordWidth, -imageHeight*coordHeight, 0.0 );
-    glTexCoord2d(coordWidth*2.0, coordHeight*2.0); glVertex3d(  imageWidth*coordWidth,  imageHeight*coordHeight, 0.0 );
-    glTexCoord2d(0.0,            coordHeight*2.0); glVertex3d( -imageWidth*coordWidth,  imageHeight*coordHeight, 0.0 );
-    glEnd();
-
-    glBindTexture(GL_TEXTURE_2D, 0);
-
-    glMatrixMode(GL_PROJECTION);
-    glPopMatrix();
-    glMatrixMode(GL_MODELVIEW);
-    glPopMatrix();
-
-    glDisable(GL_TEXTURE_2D);
-    
-    glPopAttrib();
+    return m_backgroundRenderer.init();
 }
 
 void SofaGLFWWindow::setCamera(component::visual::BaseCamera::SPtr newCamera)
@@ -250,57 +279,44 @@ void SofaGLFWWindow::centerCamera(simulation::NodeSPtr node, core::visual::Visua
 
 void SofaGLFWWindow::mouseMoveEvent(int xpos, int ypos, SofaGLFWBaseGUI* gui)
 {
+    using core::objectmodel::MouseEvent;
+
     m_currentXPos = xpos;
     m_currentYPos = ypos;
     switch (m_currentAction)
     {
         case GLFW_PRESS:
+        case GLFW_RELEASE:
         {
-            core::objectmodel::MouseEvent* mEvent = nullptr;
+            const bool isPressed = m_currentAction == GLFW_PRESS;
+            MouseEvent::State state;
             if (m_currentButton == GLFW_MOUSE_BUTTON_LEFT)
-                mEvent = new core::objectmodel::MouseEvent(core::objectmodel::MouseEvent::LeftPressed, xpos, ypos);
+                state = isPressed ? MouseEvent::LeftPressed : MouseEvent::LeftReleased;
             else if (m_currentButton == GLFW_MOUSE_BUTTON_RIGHT)
-                mEvent = new core::objectmodel::MouseEvent(core::objectmodel::MouseEvent::RightPressed, xpos, ypos);
+                state = isPressed ? MouseEvent::RightPressed : MouseEvent::RightReleased;
             else if (m_currentButton == GLFW_MOUSE_BUTTON_MIDDLE)
-                mEvent = new core::objectmodel::MouseEvent(core::objectmodel::MouseEvent::MiddlePressed, xpos, ypos);
+                state = isPressed ? MouseEvent::MiddlePressed : MouseEvent::MiddleReleased;
             else
             {
                 // A fallback event to rule them all...
-                mEvent = new core::objectmodel::MouseEvent(core::objectmodel::MouseEvent::AnyExtraButtonPressed, xpos, ypos);
+                state = isPressed ? MouseEvent::AnyExtraButtonPressed : MouseEvent::AnyExtraButtonReleased;
             }
-            m_currentCamera->manageEvent(mEvent);
-
-            auto rootNode = gui->getRootNode();
 
-            rootNode->propagateEvent(core::execparams::defaultInstance(), mEvent);
+            MouseEvent mEvent(state, xpos, ypos);
+            m_currentCamera->manageEvent(&mEvent);
 
-            break;
-        }
-        case GLFW_RELEASE:
-        {
-            core::objectmodel::MouseEvent* mEvent = nullptr;
-            if (m_currentButton == GLFW_MOUSE_BUTTON_LEFT)
-                mEvent = new core::objectmodel::MouseEvent(core::objectmodel::MouseEvent::LeftReleased, xpos, ypos);
-            else if (m_currentButton == GLFW_MOUSE_BUTTON_RIGHT)
-                mEvent = new core::objectmodel::MouseEvent(core::objectmodel::MouseEvent::RightReleased, xpos, ypos);
-            else if (m_currentButton == GLFW_MOUSE_BUTTON_MIDDLE)
-                mEvent = new core::objectmodel::MouseEvent(core::objectmodel::MouseEvent::MiddleReleased, xpos, ypos);
-            else
+            // the scene receives the event before the next step, the input handling does not wait for the step in progress
+            gui->runInScene([gui, state, xpos, ypos]()
             {
-                // A fallback event to rules them all...
-                mEvent = new core::objectmodel::MouseEvent(core::objectmodel::MouseEvent::AnyExtraButtonReleased, xpos, ypos);
-            }
-            m_currentCamera->manageEvent(mEvent);
-
-            auto rootNode = gui->getRootNode();
-
-            rootNode->propagateEvent(core::execparams::defaultInstance(), mEvent);
+                MouseEvent sceneEvent(state, xpos, ypos);
+                gui->getRootNode()->propagateEvent(core::execparams::defaultInstance(), &sceneEvent);
+            });
 
             break;
         }
         default:
         {
-            core::objectmodel::MouseEvent me(core::objectmodel::MouseEvent::Move, xpos, ypos);
+            MouseEvent me(MouseEvent::Move, xpos, ypos);
             m_currentCamera->manageEvent(&me);
             break;
         }
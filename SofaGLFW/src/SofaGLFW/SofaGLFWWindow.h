@@ -25,6 +25,8 @@
 #include <sofa/simulation/fwd.h>
 #include <sofa/component/visual/BaseCamera.h>
 #include "SofaGLFWBaseGUI.h"
+#include <SofaGLFW/BackgroundRenderer.h>
+#include <SofaGLFW/ViewerUniformBuffer.h>
 
 struct GLFWwindow;
 
@@ -48,6 +50,12 @@ public:
     virtual ~SofaGLFWWindow() = default;
 
     void draw(sofa::simulation::NodeSPtr groot, sofa::core::visual::VisualParams* vparams);
+    /**
+     * Draw the tile (x, y, width, height) of an image of imageWidth x imageHeight pixels into a viewport of the
+     * tile size, with the camera frustum restricted to the tile (see TiledRenderer).
+     */
+    void drawTile(sofa::simulation::NodeSPtr groot, sofa::core::visual::VisualParams* vparams,
+                  int imageWidth, int imageHeight, int x, int y, int width, int height);
     void close();
 
     void mouseMoveEvent(int xpos, int ypos,SofaGLFWBaseGUI* gui);
@@ -55,13 +63,28 @@ public:
     void scrollEvent(double xoffset, double yoffset);
     void setBackgroundColor(const RGBAColor& newColor);
     void setBackgroundImage(const std::string& filename);
-    void drawBackgroundImage();
+    /// Vertical gradient from the bottom of the viewport to its top, replacing the background color or image.
+    void setBackgroundGradient(const RGBAColor& bottomColor, const RGBAColor& topColor);
+
+    /**
+     * In a core profile context, the scene is drawn without the fixed-function state (matrix stacks, lights):
+     * the camera and the light are given to the shaders by a uniform buffer instead (see ViewerUniformBuffer).
+     */
+    void setCoreProfile(bool enabled) { m_bCoreProfile = enabled; }
+    bool isCoreProfile() const { return m_bCoreProfile; }
+    ViewerUniformBuffer& getViewerUniforms() { return m_viewerUniforms; }
 
     void setCamera(sofa::component::visual::BaseCamera::SPtr newCamera);
     void centerCamera(sofa::simulation::NodeSPtr node, sofa::core::visual::VisualParams* vparams) const;
     bool mouseEvent(GLFWwindow* window,int width,int height ,int button, int action, int mods, double xpos, double ypos) const;
 
 private:
+    /// Draw the region (x, y, width, height) of an image of imageWidth x imageHeight pixels into a viewport of the region size.
+    void drawRegion(sofa::simulation::NodeSPtr groot, sofa::core::visual::VisualParams* vparams,
+                    int imageWidth, int imageHeight, int x, int y, int width, int height);
+    /// Give the current background image or gradient to the background renderer. False if the background is a color.
+    bool updateBackgroundRenderer();
+
     GLFWwindow* m_glfwWindow{nullptr};
     sofa::component::visual::BaseCamera::SPtr m_currentCamera;
     int m_currentButton{ -1 };
@@ -80,6 +103,14 @@ private:
     
     std::map<std::string, Background> m_backgrounds;
     std::string m_currentBackgroundFilename{};
+
+    bool m_bBackgroundGradient{ false };
+    RGBAColor m_backgroundGradientBottom{ RGBAColor::black() };
+    RGBAColor m_backgroundGradientTop{ RGBAColor::black() };
+    BackgroundRenderer m_backgroundRenderer;
+
+    bool m_bCoreProfile{ false };
+    ViewerUniformBuffer m_viewerUniforms;
 };
 
 } // namespace sofaglfw
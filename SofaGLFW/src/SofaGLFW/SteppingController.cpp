@@ -0,0 +1,293 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU General Public License as published by the Free  *
+* Software Foundation; either version 2 of the License, or (at your option)   *
+* any later version.                                                          *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for    *
+* more details.                                                               *
+*                                                                             *
+* You should have received a copy of the GNU General Public License along     *
+* with this program. If not, see <http://www.gnu.org/licenses/>.              *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <SofaGLFW/SteppingController.h>
+
+#include <sofa/core/PathResolver.h>
+#include <sofa/core/objectmodel/BaseData.h>
+#include <sofa/helper/logging/Messaging.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <sstream>
+#include <string_view>
+
+namespace sofaglfw
+{
+
+namespace
+{
+
+enum class Comparison
+{
+    Equal,
+    NotEqual,
+    Less,
+    LessEqual,
+    Greater,
+    GreaterEqual
+};
+
+constexpr std::array<std::pair<std::string_view, Comparison>, 6> comparisons {{
+    { "==", Comparison::Equal },
+    { "!=", Comparison::NotEqual },
+    { "<", Comparison::Less },
+    { "<=", Comparison::LessEqual },
+    { ">", Comparison::Greater },
+    { ">=", Comparison::GreaterEqual }
+}};
+
+/// Parse the whole string as a number, surrounding spaces excepted.
+bool parseNumber(const std::string& text, double& number)
+{
+    const char* begin = text.c_str();
+    char* end = nullptr;
+    number = std::strtod(begin, &end);
+    if (end == begin)
+    {
+        return false;
+    }
+    while (*end == ' ' || *end == '\t' || *end == '\n')
+    {
+        ++end;
+    }
+    return *end == '\0';
+}
+
+template<class T>
+bool compare(const T& a, const T& b, Comparison comparison)
+{
+    switch (comparison)
+    {
+        case Comparison::Equal: return a == b;
+        case Comparison::NotEqual: return a != b;
+        case Comparison::Less: return a < b;
+        case Comparison::LessEqual: return a <= b;
+        case Comparison::Greater: return a > b;
+        case Comparison::GreaterEqual: return a >= b;
+    }
+    return false;
+}
+
+} // namespace
+
+void SteppingController::stepN(std::size_t nbSteps)
+{
+    if (nbSteps == 0)
+    {
+        return;
+    }
+
+    Command command;
+    command.type = Type::Steps;
+    command.nbSteps = nbSteps;
+    push(std::move(command));
+}
+
+void SteppingController::runUntilTime(double time)
+{
+    Command command;
+    command.type = Type::UntilTime;
+    command.value = time;
+    command.description = "Run until t = " + std::to_string(time) + " s";
+    push(std::move(command));
+}
+
+void SteppingController::runForWallTime(double duration)
+{
+    Command command;
+    command.type = Type::ForWallTime;
+    command.value = duration;
+    command.description = "Run for " + std::to_string(duration) + " s";
+    push(std::move(command));
+}
+
+void SteppingController::runUntil(Predicate predicate, const std::string& description, std::size_t maxNbSteps)
+{
+    if (!predicate)
+    {
+        msg_error("SteppingController") << "Cannot run until '" << description << "': invalid predicate.";
+        return;
+    }
+
+    Command command;
+    command.type = Type::UntilPredicate;
+    command.nbSteps = maxNbSteps;
+    command.predicate = std::move(predicate);
+    command.description = "Run until " + description;
+    push(std::move(command));
+}
+
+SteppingController::Predicate SteppingController::dataPredicate(const std::string& dataPath, const std::string& comparison, const std::string& value)
+{
+    const auto it = std::find_if(comparisons.begin(), comparisons.end(), [&comparison](const auto& c) { return c.first == comparison; });
+    if (it == comparisons.end())
+    {
+        msg_error("SteppingController") << "Unknown comparison '" << comparison << "'. Available comparisons: ==, !=, <, <=, >, >=.";
+        return {};
+    }
+    const Comparison op = it->second;
+
+    return [dataPath, op, value](sofa::simulation::Node* root)
+    {
+        const auto* data = sofa::core::PathResolver::FindBaseDataFromPath(root, dataPath);
+        if (!data)
+        {
+            msg_error("SteppingController") << "Cannot find the Data " << dataPath << ", stopping.";
+            return true;
+        }
+
+        const std::string current = data->getValueString();
+        double currentNumber = 0.0;
+        double valueNumber = 0.0;
+        if (parseNumber(current, currentNumber) && parseNumber(value, valueNumber))
+        {
+            return compare(currentNumber, valueNumber, op);
+        }
+        if (op == Comparison::Equal || op == Comparison::NotEqual)
+        {
+            return compare(current, value, op);
+        }
+
+        msg_error("SteppingController") << "Cannot compare the value '" << current << "' of " << dataPath
+                                        << " with '" << value << "': not a number, stopping.";
+        return true;
+    };
+}
+
+void SteppingController::cancel()
+{
+    std::lock_guard lock(m_mutex);
+    m_commands.clear();
+    ++m_nbCancels;
+    updateNbCommands();
+}
+
+std::string SteppingController::getDescription() const
+{
+    std::lock_guard lock(m_mutex);
+    if (m_isExecuting)
+    {
+        return m_executingDescription;
+    }
+    return m_commands.empty() ? std::string() : m_commands.front().description;
+}
+
+void SteppingController::push(Command command)
+{
+    std::lock_guard lock(m_mutex);
+
+    // successive step requests (e.g. a repeated button) accumulate
+    if (command.type == Type::Steps && !m_commands.empty() && m_commands.back().type == Type::Steps)
+    {
+        auto& last = m_commands.back();
+        last.nbSteps += command.nbSteps;
+        last.description = "Step " + std::to_string(last.nbSteps - last.nbStepsDone);
+        return;
+    }
+
+    if (command.type == Type::Steps)
+    {
+        command.description = "Step " + std::to_string(command.nbSteps);
+    }
+    m_commands.push_back(std::move(command));
+    updateNbCommands();
+}
+
+bool SteppingController::isDone(Command& command, sofa::simulation::Node* root)
+{
+    if (!command.isStarted)
+    {
+        command.isStarted = true;
+        command.startTime = Clock::now();
+    }
+
+    switch (command.type)
+    {
+        case Type::Steps:
+            return command.nbStepsDone >= command.nbSteps;
+        case Type::UntilTime:
+            // the accumulated time may be off by a rounding error
+            return root->getTime() + 0.5 * root->getDt() >= command.value;
+        case Type::ForWallTime:
+            return std::chrono::duration<double>(Clock::now() - command.startTime).count() >= command.value;
+        case Type::UntilPredicate:
+            return (command.nbSteps > 0 && command.nbStepsDone >= command.nbSteps) || command.predicate(root);
+    }
+    return true;
+}
+
+std::size_t SteppingController::execute(sofa::simulation::Node* root, double maxDuration, std::size_t maxNbSteps, const AnimateFunction& animate)
+{
+    const auto sliceStart = Clock::now();
+    std::size_t nbSteps = 0;
+    const auto isSliceOver = [&]()
+    {
+        return (maxNbSteps > 0 && nbSteps >= maxNbSteps)
+            || (nbSteps > 0 && std::chrono::duration<double>(Clock::now() - sliceStart).count() >= maxDuration);
+    };
+
+    while (root && !isSliceOver())
+    {
+        // the command is computed out of the lock: the predicates and animate may queue or cancel commands
+        Command command;
+        std::size_t nbCancels = 0;
+        {
+            std::lock_guard lock(m_mutex);
+            if (m_commands.empty())
+            {
+                break;
+            }
+            command = std::move(m_commands.front());
+            m_commands.pop_front();
+            m_isExecuting = true;
+            m_executingDescription = command.description;
+            nbCancels = m_nbCancels;
+            updateNbCommands();
+        }
+
+        bool isCommandDone = isDone(command, root);
+        while (!isCommandDone && !isSliceOver() && nbCancels == m_nbCancels)
+        {
+            animate();
+            ++nbSteps;
+            ++command.nbStepsDone;
+            isCommandDone = isDone(command, root);
+        }
+
+        std::lock_guard lock(m_mutex);
+        m_isExecuting = false;
+        if (!isCommandDone && nbCancels == m_nbCancels)
+        {
+            if (command.type == Type::Steps)
+            {
+                command.description = "Step " + std::to_string(command.nbSteps - command.nbStepsDone);
+            }
+            m_commands.push_front(std::move(command));
+        }
+        updateNbCommands();
+    }
+
+    return nbSteps;
+}
+
+} // namespace sofaglfw
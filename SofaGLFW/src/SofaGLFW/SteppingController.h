@@ -0,0 +1,118 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU General Public License as published by the Free  *
+* Software Foundation; either version 2 of the License, or (at your option)   *
+* any later version.                                                          *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for    *
+* more details.                                                               *
+*                                                                             *
+* You should have received a copy of the GNU General Public License along     *
+* with this program. If not, see <http://www.gnu.org/licenses/>.              *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#pragma once
+#include <SofaGLFW/config.h>
+
+#include <sofa/simulation/Node.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+
+namespace sofaglfw
+{
+
+/**
+ * @brief Queue of stepping commands: compute N steps, run until a simulation time, run for a wall-clock
+ * duration, or run until a predicate holds.
+ *
+ * Commands are queued from any thread (GUI, keyboard, scripts) and computed by execute(), from the thread
+ * stepping the simulation. Their steps are batched: the visual models are only updated, and the scene
+ * drawn, between two calls to execute(). Commands run whether the simulation is running or paused.
+ */
+class SOFAGLFW_API SteppingController
+{
+public:
+    using Predicate = std::function<bool(sofa::simulation::Node* root)>;
+    using AnimateFunction = std::function<void()>;
+
+    void stepN(std::size_t nbSteps);
+    void runUntilTime(double time);
+    void runForWallTime(double duration);
+
+    /// Run until the predicate holds (evaluated before each step), or after maxNbSteps steps if not 0.
+    void runUntil(Predicate predicate, const std::string& description, std::size_t maxNbSteps = 0);
+
+    /**
+     * Predicate comparing the value of a Data, given by its path (e.g. "@/node/object.name"), with a value.
+     * The comparison is one of ==, !=, <, <=, >, >=. The ordering comparisons require numerical values.
+     */
+    static Predicate dataPredicate(const std::string& dataPath, const std::string& comparison, const std::string& value);
+
+    /// Discard all the commands, including the one in progress.
+    void cancel();
+
+    bool isBusy() const { return m_nbCommands.load() > 0; }
+
+    /// Description of the command in progress (empty if idle).
+    std::string getDescription() const;
+
+    /**
+     * Compute the steps of the queued commands for at most maxDuration seconds of wall-clock time (at least one step)
+     * and at most maxNbSteps steps (no limit if 0). animate computes one step. Returns the number of steps computed.
+     */
+    std::size_t execute(sofa::simulation::Node* root, double maxDuration, std::size_t maxNbSteps, const AnimateFunction& animate);
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    enum class Type
+    {
+        Steps,
+        UntilTime,
+        ForWallTime,
+        UntilPredicate
+    };
+
+    struct Command
+    {
+        Type type { Type::Steps };
+        std::size_t nbSteps { 0 };      ///< number of steps (Steps), maximum number of steps (UntilPredicate, 0: no limit)
+        std::size_t nbStepsDone { 0 };
+        double value { 0.0 };           ///< simulation time (UntilTime), duration in seconds (ForWallTime)
+        Predicate predicate;
+        std::string description;
+        bool isStarted { false };
+        Clock::time_point startTime;
+    };
+
+    void push(Command command);
+
+    /// Returns true if the command is done, i.e. its next step must not be computed.
+    static bool isDone(Command& command, sofa::simulation::Node* root);
+
+    /// Must be called with m_mutex held.
+    void updateNbCommands() { m_nbCommands = m_commands.size() + (m_isExecuting ? 1 : 0); }
+
+    mutable std::mutex m_mutex;
+    std::deque<Command> m_commands;
+    bool m_isExecuting { false };           ///< the front command is taken out of the queue by execute()
+    std::string m_executingDescription;
+    std::atomic<std::size_t> m_nbCommands { 0 };
+    std::atomic<std::size_t> m_nbCancels { 0 }; ///< discards the command being executed when it changes
+};
+
+} // namespace sofaglfw
@@ -0,0 +1,172 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU General Public License as published by the Free  *
+* Software Foundation; either version 2 of the License, or (at your option)   *
+* any later version.                                                          *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for    *
+* more details.                                                               *
+*                                                                             *
+* You should have received a copy of the GNU General Public License along     *
+* with this program. If not, see <http://www.gnu.org/licenses/>.              *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <SofaGLFW/TiledRenderer.h>
+
+#include <sofa/gl/gl.h>
+#include <sofa/helper/logging/Messaging.h>
+
+#include <algorithm>
+
+namespace sofaglfw
+{
+
+void TiledRenderer::getTileProjectionMatrix(const double imageProjection[16], int imageWidth, int imageHeight,
+                                            int x, int y, int width, int height, double tileProjection[16])
+{
+    // maps the normalized device coordinates of the tile to [-1, 1]: x' = sx * x + ox, applied to the clip coordinates
+    const double sx = static_cast<double>(imageWidth) / width;
+    const double sy = static_cast<double>(imageHeight) / height;
+    const double ox = static_cast<double>(imageWidth - 2 * x - width) / width;
+    const double oy = static_cast<double>(imageHeight - 2 * y - height) / height;
+
+    for (int column = 0; column < 4; ++column)
+    {
+        const double* source = imageProjection + 4 * column;
+        double* target = tileProjection + 4 * column;
+        target[0] = sx * source[0] + ox * source[3];
+        target[1] = sy * source[1] + oy * source[3];
+        target[2] = source[2];
+        target[3] = source[3];
+    }
+}
+
+bool TiledRenderer::resizeFrameBuffer(int tileSize)
+{
+    if (m_frameBuffer != 0 && tileSize == m_tileSize)
+    {
+        return true;
+    }
+
+    if (m_frameBuffer == 0)
+    {
+        glGenFramebuffers(1, &m_frameBuffer);
+        glGenRenderbuffers(1, &m_colorBuffer);
+        glGenRenderbuffers(1, &m_depthBuffer);
+    }
+
+    glBindRenderbuffer(GL_RENDERBUFFER, m_colorBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, tileSize, tileSize);
+    glBindRenderbuffer(GL_RENDERBUFFER, m_depthBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, tileSize, tileSize);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, m_frameBuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, m_colorBuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, m_depthBuffer);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+    {
+        msg_error("TiledRenderer") << "Cannot create a frame buffer of " << tileSize << "x" << tileSize << " pixels";
+        return false;
+    }
+
+    m_tileSize = tileSize;
+    return true;
+}
+
+bool TiledRenderer::render(int width, int height, const DrawTileFunction& drawTile, const BandFunction& writeBand)
+{
+    if (width <= 0 || height <= 0)
+    {
+        return false;
+    }
+
+    GLint maxRenderbufferSize = 0;
+    glGetIntegerv(GL_MAX_RENDERBUFFER_SIZE, &maxRenderbufferSize);
+    GLint maxViewportDims[2] = { 0, 0 };
+    glGetIntegerv(GL_MAX_VIEWPORT_DIMS, maxViewportDims);
+    const int tileSize = std::max(1, std::min({ m_maxTileSize, static_cast<int>(maxRenderbufferSize), static_cast<int>(maxViewportDims[0]),
+                                                static_cast<int>(maxViewportDims[1]), std::max(width, height) }));
+
+    GLint previousReadFrameBuffer = 0;
+    glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &previousReadFrameBuffer);
+    GLint previousDrawFrameBuffer = 0;
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previousDrawFrameBuffer);
+    GLint previousViewport[4];
+    glGetIntegerv(GL_VIEWPORT, previousViewport);
+    GLint previousPackAlignment = 4;
+    glGetIntegerv(GL_PACK_ALIGNMENT, &previousPackAlignment);
+
+    const auto restoreState = [&]()
+    {
+        glPixelStorei(GL_PACK_ROW_LENGTH, 0);
+        glPixelStorei(GL_PACK_ALIGNMENT, previousPackAlignment);
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, static_cast<GLuint>(previousReadFrameBuffer));
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, static_cast<GLuint>(previousDrawFrameBuffer));
+        glViewport(previousViewport[0], previousViewport[1], previousViewport[2], previousViewport[3]);
+    };
+
+    if (!resizeFrameBuffer(tileSize))
+    {
+        restoreState();
+        return false;
+    }
+
+    // a band of tiles of the image width: the only part of the image in memory
+    m_band.resize(static_cast<std::size_t>(width) * static_cast<std::size_t>(std::min(tileSize, height)) * 4);
+
+    for (int bandTop = height; bandTop > 0; bandTop -= tileSize)
+    {
+        const int bandBottom = std::max(0, bandTop - tileSize);
+        const int bandHeight = bandTop - bandBottom;
+
+        for (int x = 0; x < width; x += tileSize)
+        {
+            const int tileWidth = std::min(tileSize, width - x);
+
+            glBindFramebuffer(GL_FRAMEBUFFER, m_frameBuffer);
+            glViewport(0, 0, tileWidth, bandHeight);
+            drawTile(x, bandBottom, tileWidth, bandHeight);
+
+            // the tile is written at its place in the band
+            glBindFramebuffer(GL_READ_FRAMEBUFFER, m_frameBuffer);
+            glPixelStorei(GL_PACK_ALIGNMENT, 1);
+            glPixelStorei(GL_PACK_ROW_LENGTH, width);
+            glReadPixels(0, 0, tileWidth, bandHeight, GL_RGBA, GL_UNSIGNED_BYTE, m_band.data() + static_cast<std::size_t>(x) * 4);
+            glPixelStorei(GL_PACK_ROW_LENGTH, 0);
+        }
+
+        if (!writeBand(m_band.data(), bandHeight))
+        {
+            restoreState();
+            return false;
+        }
+    }
+
+    restoreState();
+    return true;
+}
+
+void TiledRenderer::release()
+{
+    if (m_frameBuffer != 0)
+    {
+        glDeleteFramebuffers(1, &m_frameBuffer);
+        glDeleteRenderbuffers(1, &m_colorBuffer);
+        glDeleteRenderbuffers(1, &m_depthBuffer);
+    }
+    m_frameBuffer = m_colorBuffer = m_depthBuffer = 0;
+    m_tileSize = 0;
+    m_band.clear();
+    m_band.shrink_to_fit();
+}
+
+} // namespace sofaglfw
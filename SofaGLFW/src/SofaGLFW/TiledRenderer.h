@@ -0,0 +1,83 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU General Public License as published by the Free  *
+* Software Foundation; either version 2 of the License, or (at your option)   *
+* any later version.                                                          *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for    *
+* more details.                                                               *
+*                                                                             *
+* You should have received a copy of the GNU General Public License along     *
+* with this program. If not, see <http://www.gnu.org/licenses/>.              *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#pragma once
+#include <SofaGLFW/config.h>
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace sofaglfw
+{
+
+/**
+ * @brief Renders an image larger than the frame buffers supported by the driver (e.g. posters), tile by tile.
+ *
+ * The image is split into tiles drawn one at a time into a single off-screen frame buffer of the tile size,
+ * reused for all the tiles: the caller draws each tile with the camera frustum restricted to it (see
+ * getTileProjectionMatrix). The tiles are read back and gathered into bands of the image width, handed out
+ * from the top of the image to the bottom, so that only one band is in memory at a time.
+ *
+ * Requires a current OpenGL context. The GPU resources must be released explicitly before the context is destroyed.
+ */
+class SOFAGLFW_API TiledRenderer
+{
+public:
+    /// Draw the tile of the image at (x, y) (from the bottom-left corner) of size width x height, into the current viewport.
+    using DrawTileFunction = std::function<void(int x, int y, int width, int height)>;
+    /// Receive nbRows rows of RGBA pixels of the image width, from bottom to top (as read by OpenGL).
+    using BandFunction = std::function<bool(const std::uint8_t* pixels, int nbRows)>;
+
+    TiledRenderer() = default;
+    ~TiledRenderer() = default;
+
+    TiledRenderer(const TiledRenderer&) = delete;
+    TiledRenderer& operator=(const TiledRenderer&) = delete;
+
+    /// Maximum size of the tiles, bounded by the limits of the driver. 2048 by default.
+    void setMaxTileSize(int size) { m_maxTileSize = size; }
+
+    /**
+     * Multiply the projection matrix of the whole image (column-major, as OpenGL) by the transformation
+     * restricting it to the tile, for perspective and orthographic projections alike.
+     */
+    static void getTileProjectionMatrix(const double imageProjection[16], int imageWidth, int imageHeight,
+                                        int x, int y, int width, int height, double tileProjection[16]);
+
+    /// Render the image, band by band from the top. Stops and returns false if writeBand returns false.
+    bool render(int width, int height, const DrawTileFunction& drawTile, const BandFunction& writeBand);
+
+    /// Delete the GPU resources. Must be called while the context is current.
+    void release();
+
+private:
+    bool resizeFrameBuffer(int tileSize);
+
+    int m_maxTileSize { 2048 };
+    int m_tileSize { 0 };
+    unsigned int m_frameBuffer { 0 };
+    unsigned int m_colorBuffer { 0 };
+    unsigned int m_depthBuffer { 0 };
+    std::vector<std::uint8_t> m_band;
+};
+
+} // namespace sofaglfw
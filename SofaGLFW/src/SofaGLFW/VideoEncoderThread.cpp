@@ -0,0 +1,197 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU General Public License as published by the Free  *
+* Software Foundation; either version 2 of the License, or (at your option)   *
+* any later version.                                                          *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for    *
+* more details.                                                               *
+*                                                                             *
+* You should have received a copy of the GNU General Public License along     *
+* with this program. If not, see <http://www.gnu.org/licenses/>.              *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <SofaGLFW/VideoEncoderThread.h>
+
+#include <algorithm>
+#include <chrono>
+
+namespace sofaglfw
+{
+
+namespace
+{
+/// the capture interval of the Degrade policy grows up to this value
+constexpr std::size_t maxCaptureInterval = 8;
+}
+
+const char* VideoEncoderThread::toString(QueuePolicy policy)
+{
+    return policyNames[static_cast<std::size_t>(policy)];
+}
+
+std::optional<VideoEncoderThread::QueuePolicy> VideoEncoderThread::policyFromString(const std::string& name)
+{
+    for (std::size_t i = 0; i < policyNames.size(); ++i)
+    {
+        if (name == policyNames[i])
+        {
+            return static_cast<QueuePolicy>(i);
+        }
+    }
+    return std::nullopt;
+}
+
+VideoEncoderThread::~VideoEncoderThread()
+{
+    stop();
+}
+
+void VideoEncoderThread::start(EncodeFunction encode)
+{
+    stop();
+
+    m_encode = std::move(encode);
+    m_stopRequested = false;
+    m_captureInterval = 1;
+    m_nbFramesSinceCapture = 0;
+    m_nbEncodedFrames = 0;
+    m_nbDroppedFrames = 0;
+    m_lastEncodeTime = 0.0;
+    m_averageEncodeTime = 0.0;
+    m_statsCaptureInterval = 1;
+
+    m_thread = std::thread(&VideoEncoderThread::loop, this);
+}
+
+void VideoEncoderThread::stop()
+{
+    if (!m_thread.joinable())
+    {
+        return;
+    }
+
+    {
+        std::lock_guard lock(m_mutex);
+        m_stopRequested = true;
+    }
+    m_frameQueued.notify_one();
+    m_thread.join();
+}
+
+bool VideoEncoderThread::isFrameWanted()
+{
+    std::size_t queueDepth = 0;
+    {
+        std::lock_guard lock(m_mutex);
+        queueDepth = m_queue.size();
+    }
+
+    switch (m_policy)
+    {
+        case QueuePolicy::Block:
+            return true;
+        case QueuePolicy::Drop:
+            if (queueDepth >= m_capacity)
+            {
+                ++m_nbDroppedFrames;
+                return false;
+            }
+            return true;
+        case QueuePolicy::Degrade:
+            if (++m_nbFramesSinceCapture < m_captureInterval)
+            {
+                ++m_nbDroppedFrames;
+                return false;
+            }
+            m_nbFramesSinceCapture = 0;
+
+            // capture less often while the encoder cannot keep up, more often once it has caught up
+            if (queueDepth >= m_capacity)
+            {
+                m_captureInterval = std::min(2 * m_captureInterval, maxCaptureInterval);
+            }
+            else if (queueDepth <= m_capacity / 4 && m_captureInterval > 1)
+            {
+                --m_captureInterval;
+            }
+            m_statsCaptureInterval = m_captureInterval;
+            return true;
+    }
+    return true;
+}
+
+void VideoEncoderThread::push(PixelFramePtr frame)
+{
+    std::unique_lock lock(m_mutex);
+    if (m_queue.size() >= m_capacity)
+    {
+        if (m_policy != QueuePolicy::Block)
+        {
+            // only the Block policy waits, the frame was wanted before the queue filled up
+            ++m_nbDroppedFrames;
+            return;
+        }
+        m_frameEncoded.wait(lock, [this] { return m_queue.size() < m_capacity || !m_thread.joinable(); });
+    }
+
+    m_queue.push_back(std::move(frame));
+    lock.unlock();
+
+    m_frameQueued.notify_one();
+}
+
+VideoEncoderThread::Stats VideoEncoderThread::getStats() const
+{
+    Stats stats;
+    {
+        std::lock_guard lock(m_mutex);
+        stats.queueDepth = m_queue.size();
+    }
+    stats.nbEncodedFrames = m_nbEncodedFrames;
+    stats.nbDroppedFrames = m_nbDroppedFrames;
+    stats.lastEncodeTime = m_lastEncodeTime;
+    stats.averageEncodeTime = m_averageEncodeTime;
+    stats.captureInterval = m_statsCaptureInterval;
+    return stats;
+}
+
+void VideoEncoderThread::loop()
+{
+    std::unique_lock lock(m_mutex);
+    while (true)
+    {
+        m_frameQueued.wait(lock, [this] { return !m_queue.empty() || m_stopRequested; });
+        if (m_queue.empty())
+        {
+            break; // stop requested and every queued frame is encoded
+        }
+
+        // the frame stays in the queue while it is encoded, so that the queue depth includes it
+        const PixelFramePtr frame = m_queue.front();
+        lock.unlock();
+
+        const auto encodeStart = std::chrono::steady_clock::now();
+        m_encode(frame);
+        const double encodeTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - encodeStart).count();
+
+        m_lastEncodeTime = encodeTime;
+        m_averageEncodeTime = (m_nbEncodedFrames == 0) ? encodeTime : 0.9 * m_averageEncodeTime.load() + 0.1 * encodeTime;
+        ++m_nbEncodedFrames;
+
+        // releasing the frame gives its storage back to the readback
+        lock.lock();
+        m_queue.pop_front();
+        m_frameEncoded.notify_one();
+    }
+}
+
+} // namespace sofaglfw
@@ -0,0 +1,125 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU General Public License as published by the Free  *
+* Software Foundation; either version 2 of the License, or (at your option)   *
+* any later version.                                                          *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for    *
+* more details.                                                               *
+*                                                                             *
+* You should have received a copy of the GNU General Public License along     *
+* with this program. If not, see <http://www.gnu.org/licenses/>.              *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#pragma once
+#include <SofaGLFW/config.h>
+#include <SofaGLFW/PixelReadbackRing.h>
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+
+namespace sofaglfw
+{
+
+/**
+ * @brief Encodes the recorded frames on a dedicated thread, so that the render loop does not wait for the encoder.
+ *
+ * The render thread pushes the frames read back from the GPU into a bounded queue, without copying them.
+ * The encoder thread writes the queued frames in order, and releases each one once written. When the queue
+ * is full, the policy decides whether the render thread waits, or which frames are not recorded.
+ */
+class SOFAGLFW_API VideoEncoderThread
+{
+public:
+    enum class QueuePolicy
+    {
+        Block,  ///< the render thread waits for room in the queue: every frame is recorded
+        Drop,   ///< the frames arriving while the queue is full are not recorded: the video is shorter
+        Degrade ///< only one frame out of N is captured, N adapting to the encoder speed: the frames are skipped evenly instead of in bursts
+    };
+
+    static constexpr std::array<const char*, 3> policyNames { "block", "drop", "degrade" };
+    static const char* toString(QueuePolicy policy);
+    static std::optional<QueuePolicy> policyFromString(const std::string& name);
+
+    /// Writes a frame, in the pixel format it was read back by the GUI engine, into the video. Called from the encoder thread only.
+    /// The frame can be kept beyond the call (e.g. handed to other threads).
+    using EncodeFunction = std::function<void(const PixelFramePtr& frame)>;
+
+    VideoEncoderThread() = default;
+    ~VideoEncoderThread();
+
+    VideoEncoderThread(const VideoEncoderThread&) = delete;
+    VideoEncoderThread& operator=(const VideoEncoderThread&) = delete;
+
+    void start(EncodeFunction encode);
+    /// Encode the frames remaining in the queue, then stop the thread.
+    void stop();
+    bool isRunning() const { return m_thread.joinable(); }
+
+    void setQueuePolicy(QueuePolicy policy) { m_policy = policy; }
+    QueuePolicy getQueuePolicy() const { return m_policy; }
+    void setQueueCapacity(std::size_t nbFrames) { m_capacity = nbFrames > 0 ? nbFrames : 1; }
+    std::size_t getQueueCapacity() const { return m_capacity; }
+
+    /// Returns false if the next frame must not be captured (full queue with the Drop policy, skipped frame with the Degrade policy).
+    bool isFrameWanted();
+
+    /// Queue a frame captured after isFrameWanted() returned true. Waits for room in the queue with the Block policy.
+    void push(PixelFramePtr frame);
+
+    struct Stats
+    {
+        std::size_t queueDepth { 0 };
+        std::size_t nbEncodedFrames { 0 };
+        std::size_t nbDroppedFrames { 0 };  ///< frames not captured by the Drop and Degrade policies
+        double lastEncodeTime { 0.0 };      ///< seconds
+        double averageEncodeTime { 0.0 };   ///< seconds, exponential moving average
+        std::size_t captureInterval { 1 };  ///< N of the Degrade policy
+    };
+    Stats getStats() const;
+
+private:
+    void loop();
+
+    std::thread m_thread;
+    EncodeFunction m_encode;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_frameQueued;
+    std::condition_variable m_frameEncoded;
+    std::deque<PixelFramePtr> m_queue;
+    bool m_stopRequested { false };
+
+    QueuePolicy m_policy { QueuePolicy::Block };
+    std::size_t m_capacity { 8 };
+
+    // Degrade policy, render thread only
+    std::size_t m_captureInterval { 1 };
+    std::size_t m_nbFramesSinceCapture { 0 };
+
+    std::atomic<std::size_t> m_nbEncodedFrames { 0 };
+    std::atomic<std::size_t> m_nbDroppedFrames { 0 };
+    std::atomic<double> m_lastEncodeTime { 0.0 };
+    std::atomic<double> m_averageEncodeTime { 0.0 };
+    std::atomic<std::size_t> m_statsCaptureInterval { 1 };
+};
+
+} // namespace sofaglfw
@@ -0,0 +1,159 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU General Public License as published by the Free  *
+* Software Foundation; either version 2 of the License, or (at your option)   *
+* any later version.                                                          *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for    *
+* more details.                                                               *
+*                                                                             *
+* You should have received a copy of the GNU General Public License along     *
+* with this program. If not, see <http://www.gnu.org/licenses/>.              *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <SofaGLFW/ViewerUniformBuffer.h>
+
+#include <sofa/gl/gl.h>
+#include <sofa/helper/logging/Messaging.h>
+
+#include <cmath>
+
+namespace sofaglfw
+{
+
+namespace
+{
+
+// std140: only vec4 and mat4 members, no padding
+struct ViewerBlock
+{
+    GLfloat projectionMatrix[16];
+    GLfloat modelViewMatrix[16];
+    GLfloat normalMatrix[16];
+    GLfloat viewport[4];
+    GLfloat lightPosition[4];
+    GLfloat lightAmbient[4];
+    GLfloat lightDiffuse[4];
+    GLfloat lightSpecular[4];
+};
+
+void copy(const std::array<float, 4>& source, GLfloat destination[4])
+{
+    for (std::size_t i = 0; i < 4; ++i)
+    {
+        destination[i] = source[i];
+    }
+}
+
+// inverse transpose of the upper 3x3 part of the model-view matrix, in a column-major 4x4 matrix
+void computeNormalMatrix(const double m[16], GLfloat normal[16])
+{
+    const auto at = [m](int row, int column) { return m[column * 4 + row]; };
+    const double cofactors[3][3] = {
+        { at(1, 1) * at(2, 2) - at(1, 2) * at(2, 1), at(1, 2) * at(2, 0) - at(1, 0) * at(2, 2), at(1, 0) * at(2, 1) - at(1, 1) * at(2, 0) },
+        { at(0, 2) * at(2, 1) - at(0, 1) * at(2, 2), at(0, 0) * at(2, 2) - at(0, 2) * at(2, 0), at(0, 1) * at(2, 0) - at(0, 0) * at(2, 1) },
+        { at(0, 1) * at(1, 2) - at(0, 2) * at(1, 1), at(0, 2) * at(1, 0) - at(0, 0) * at(1, 2), at(0, 0) * at(1, 1) - at(0, 1) * at(1, 0) },
+    };
+    const double determinant = at(0, 0) * cofactors[0][0] + at(0, 1) * cofactors[0][1] + at(0, 2) * cofactors[0][2];
+    const double inverseDeterminant = std::abs(determinant) > 1e-30 ? 1.0 / determinant : 0.0;
+
+    // the inverse transpose is the matrix of the cofactors divided by the determinant
+    for (int column = 0; column < 4; ++column)
+    {
+        for (int row = 0; row < 4; ++row)
+        {
+            normal[column * 4 + row] = (row < 3 && column < 3) ? static_cast<GLfloat>(cofactors[row][column] * inverseDeterminant)
+                                                               : (row == column ? 1.f : 0.f);
+        }
+    }
+}
+
+} // namespace
+
+bool ViewerUniformBuffer::init()
+{
+    if (isInitialized() || m_bInitFailed)
+    {
+        return isInitialized();
+    }
+
+    GLint maxBlockSize = 0;
+    glGetIntegerv(GL_MAX_UNIFORM_BLOCK_SIZE, &maxBlockSize);
+    if (maxBlockSize < static_cast<GLint>(sizeof(ViewerBlock)))
+    {
+        msg_error("ViewerUniformBuffer") << "Uniform buffers are not supported by the OpenGL context";
+        m_bInitFailed = true;
+        return false;
+    }
+
+    glGenBuffers(1, &m_buffer);
+    glBindBuffer(GL_UNIFORM_BUFFER, m_buffer);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(ViewerBlock), nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+    return true;
+}
+
+void ViewerUniformBuffer::setLight(const ViewerLight& light)
+{
+    m_light = light;
+}
+
+void ViewerUniformBuffer::update(const double projectionMatrix[16], const double modelViewMatrix[16], int x, int y, int width, int height)
+{
+    if (!isInitialized())
+    {
+        return;
+    }
+
+    ViewerBlock block;
+    for (std::size_t i = 0; i < 16; ++i)
+    {
+        block.projectionMatrix[i] = static_cast<GLfloat>(projectionMatrix[i]);
+        block.modelViewMatrix[i] = static_cast<GLfloat>(modelViewMatrix[i]);
+    }
+    computeNormalMatrix(modelViewMatrix, block.normalMatrix);
+    block.viewport[0] = static_cast<GLfloat>(x);
+    block.viewport[1] = static_cast<GLfloat>(y);
+    block.viewport[2] = static_cast<GLfloat>(width);
+    block.viewport[3] = static_cast<GLfloat>(height);
+    copy(m_light.position, block.lightPosition);
+    copy(m_light.ambient, block.lightAmbient);
+    copy(m_light.diffuse, block.lightDiffuse);
+    copy(m_light.specular, block.lightSpecular);
+
+    glBindBuffer(GL_UNIFORM_BUFFER, m_buffer);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(ViewerBlock), &block);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    glBindBufferBase(GL_UNIFORM_BUFFER, bindingPoint, m_buffer);
+}
+
+void ViewerUniformBuffer::bindProgram(unsigned int program)
+{
+    const GLuint blockIndex = glGetUniformBlockIndex(program, blockName);
+    if (blockIndex != GL_INVALID_INDEX)
+    {
+        glUniformBlockBinding(program, blockIndex, bindingPoint);
+    }
+}
+
+void ViewerUniformBuffer::release()
+{
+    if (!isInitialized())
+    {
+        return;
+    }
+
+    glDeleteBuffers(1, &m_buffer);
+    m_buffer = 0;
+}
+
+} // namespace sofaglfw
@@ -0,0 +1,94 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU General Public License as published by the Free  *
+* Software Foundation; either version 2 of the License, or (at your option)   *
+* any later version.                                                          *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for    *
+* more details.                                                               *
+*                                                                             *
+* You should have received a copy of the GNU General Public License along     *
+* with this program. If not, see <http://www.gnu.org/licenses/>.              *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#pragma once
+#include <SofaGLFW/config.h>
+
+#include <array>
+
+namespace sofaglfw
+{
+
+/// The light of the viewer, attached to the camera.
+struct ViewerLight
+{
+    std::array<float, 4> ambient { 0.5f, 0.5f, 0.5f, 1.0f };
+    std::array<float, 4> diffuse { 0.9f, 0.9f, 0.9f, 1.0f };
+    std::array<float, 4> specular { 1.0f, 1.0f, 1.0f, 1.0f };
+    std::array<float, 4> position { -0.7f, 0.3f, 0.0f, 1.0f };  ///< in eye coordinates
+};
+
+/**
+ * @brief Uniform buffer holding the camera and the light of the viewer, for shaders running without the
+ * fixed-function state of the legacy profile (glLight, glMatrixMode, ...).
+ *
+ * The buffer is updated once per drawn view and bound to the binding point bindingPoint. A shader uses it
+ * by declaring the block below (std140 layout), then calling bindProgram once it is linked:
+ *
+ *     layout(std140) uniform SofaGLFWViewer
+ *     {
+ *         mat4 projectionMatrix;
+ *         mat4 modelViewMatrix;
+ *         mat4 normalMatrix;      // inverse transpose of the model-view, in the upper 3x3 part
+ *         vec4 viewport;          // x, y, width, height
+ *         vec4 lightPosition;     // in eye coordinates
+ *         vec4 lightAmbient;
+ *         vec4 lightDiffuse;
+ *         vec4 lightSpecular;
+ *     };
+ *
+ * Requires a current OpenGL 3.1 context. The GPU resources must be released explicitly before the context is destroyed.
+ */
+class SOFAGLFW_API ViewerUniformBuffer
+{
+public:
+    static constexpr unsigned int bindingPoint { 0 };
+    static constexpr const char* blockName { "SofaGLFWViewer" };
+
+    ViewerUniformBuffer() = default;
+    ~ViewerUniformBuffer() = default;
+
+    ViewerUniformBuffer(const ViewerUniformBuffer&) = delete;
+    ViewerUniformBuffer& operator=(const ViewerUniformBuffer&) = delete;
+
+    /// Create the buffer. Returns false if the context does not support uniform buffers (without trying again).
+    bool init();
+    bool isInitialized() const { return m_buffer != 0; }
+
+    void setLight(const ViewerLight& light);
+    const ViewerLight& getLight() const { return m_light; }
+
+    /// Upload the matrices of the camera (column-major, as OpenGL) and the viewport, and bind the buffer to bindingPoint.
+    void update(const double projectionMatrix[16], const double modelViewMatrix[16], int x, int y, int width, int height);
+
+    /// Connect the block of the program, if it declares it, to the binding point of the buffer.
+    static void bindProgram(unsigned int program);
+
+    /// Delete the GPU resources. Must be called while the context is current.
+    void release();
+
+private:
+    unsigned int m_buffer { 0 };
+    bool m_bInitFailed { false };
+    ViewerLight m_light;
+};
+
+} // namespace sofaglfw
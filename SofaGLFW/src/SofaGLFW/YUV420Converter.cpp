@@ -0,0 +1,323 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU General Public License as published by the Free  *
+* Software Foundation; either version 2 of the License, or (at your option)   *
+* any later version.                                                          *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for    *
+* more details.                                                               *
+*                                                                             *
+* You should have received a copy of the GNU General Public License along     *
+* with this program. If not, see <http://www.gnu.org/licenses/>.              *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <SofaGLFW/YUV420Converter.h>
+#include <SofaGLFW/GLSLProgram.h>
+
+#include <sofa/gl/gl.h>
+#include <sofa/helper/logging/Messaging.h>
+
+#include <algorithm>
+#include <string>
+
+namespace sofaglfw
+{
+
+namespace
+{
+
+constexpr const char* vertexShaderSource = R"(
+VERTEX_IN vec2 position;
+void main()
+{
+    gl_Position = vec4(position, 0.0, 1.0);
+}
+)";
+
+// Each fragment writes 4 consecutive bytes of the planes: the Y plane (width x height bytes), then the U and
+// V planes (width/2 x height/2 bytes each), stored two chroma rows per row of the target.
+constexpr const char* fragmentShaderSource = R"(
+uniform sampler2D source;
+uniform vec2 sourceSize;
+uniform vec4 region;     // rectangle of the texture converted, in texels
+uniform vec2 imageSize;
+uniform vec2 nbSamples;  // samples per pixel along x and y: more than one when the texture is downscaled
+
+const int maxNbSamples = 8;
+
+// color of the pixel of the image, rows from top to bottom: average of the texels it covers (box filter),
+// so that a downscaled image does not alias
+vec3 fetch(vec2 pixel)
+{
+    vec2 footprint = region.zw / imageSize;
+    vec2 origin = vec2(region.x + pixel.x * footprint.x, region.y + region.w - (pixel.y + 1.0) * footprint.y);
+    vec2 sampleStep = footprint / nbSamples;
+
+    vec3 color = vec3(0.0);
+    for (int j = 0; j < maxNbSamples; ++j)
+    {
+        if (float(j) >= nbSamples.y)
+            break;
+        for (int i = 0; i < maxNbSamples; ++i)
+        {
+            if (float(i) >= nbSamples.x)
+                break;
+            color += texture(source, (origin + (vec2(float(i), float(j)) + 0.5) * sampleStep) / sourceSize).rgb;
+        }
+    }
+    return color / (nbSamples.x * nbSamples.y);
+}
+
+float planeByte(float column, float row)
+{
+    if (row < imageSize.y)
+    {
+        return dot(fetch(vec2(column, row)), vec3(0.257, 0.504, 0.098)) + 16.0 / 255.0;
+    }
+
+    float chromaRow = row - imageSize.y;
+    float planeHeight = imageSize.y * 0.25;
+    bool isV = chromaRow >= planeHeight;
+    if (isV)
+    {
+        chromaRow -= planeHeight;
+    }
+    float halfWidth = imageSize.x * 0.5;
+    vec2 block = 2.0 * vec2(mod(column, halfWidth), 2.0 * chromaRow + (column >= halfWidth ? 1.0 : 0.0));
+    vec3 color = 0.25 * (fetch(block) + fetch(block + vec2(1.0, 0.0)) + fetch(block + vec2(0.0, 1.0)) + fetch(block + vec2(1.0, 1.0)));
+
+    return (isV ? dot(color, vec3(0.439, -0.368, -0.071)) : dot(color, vec3(-0.148, -0.291, 0.439))) + 128.0 / 255.0;
+}
+
+void main()
+{
+    float row = floor(gl_FragCoord.y);
+    float column = 4.0 * floor(gl_FragCoord.x);
+    FRAG_COLOR = vec4(planeByte(column, row), planeByte(column + 1.0, row), planeByte(column + 2.0, row), planeByte(column + 3.0, row));
+}
+)";
+
+void createColorTarget(GLuint& frameBuffer, GLuint& texture)
+{
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+
+    glGenFramebuffers(1, &frameBuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, frameBuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture, 0);
+}
+
+} // namespace
+
+sofa::type::Vec2i YUV420Converter::getImageSize(int width, int height)
+{
+    // 4 bytes per texel, a chroma row is half the width, and each chroma plane fills height / 4 rows of the target
+    return { std::max(0, width) / 8 * 8, std::max(0, height) / 4 * 4 };
+}
+
+bool YUV420Converter::init()
+{
+    if (isInitialized())
+    {
+        return true;
+    }
+
+    const GLuint program = GLSLProgram::create("YUV420Converter", vertexShaderSource, fragmentShaderSource, { { 0, "position" } });
+    if (program == 0)
+    {
+        return false;
+    }
+    m_program = program;
+
+    // a single triangle covering the target
+    constexpr GLfloat triangle[] = { -1.f, -1.f, 3.f, -1.f, -1.f, 3.f };
+    glGenBuffers(1, &m_vertexBuffer);
+    glBindBuffer(GL_ARRAY_BUFFER, m_vertexBuffer);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(triangle), triangle, GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    // a core profile has no default vertex array
+    if (GLSLProgram::isCoreProfileContext())
+    {
+        glGenVertexArrays(1, &m_vertexArray);
+    }
+
+    GLint previousFrameBuffer = 0;
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previousFrameBuffer);
+    createColorTarget(m_targetFrameBuffer, m_targetTexture);
+    createColorTarget(m_sourceFrameBuffer, m_sourceTexture);
+    glBindFramebuffer(GL_FRAMEBUFFER, static_cast<GLuint>(previousFrameBuffer));
+    glBindTexture(GL_TEXTURE_2D, 0);
+    m_targetSize = m_sourceSize = { 1, 1 };
+
+    return true;
+}
+
+void YUV420Converter::resizeTarget(unsigned int texture, const sofa::type::Vec2i& size, sofa::type::Vec2i& currentSize)
+{
+    if (currentSize != size)
+    {
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, size[0], size[1], 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        currentSize = size;
+    }
+}
+
+bool YUV420Converter::convertTexture(unsigned int texture, const sofa::type::Vec2i& textureSize, const sofa::type::Vec2i& imageSize)
+{
+    if (!isInitialized() || imageSize != getImageSize(imageSize[0], imageSize[1])
+        || imageSize[0] <= 0 || imageSize[1] <= 0 || textureSize[0] <= 0 || textureSize[1] <= 0)
+    {
+        return false;
+    }
+
+    glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &m_previousReadFrameBuffer);
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &m_previousDrawFrameBuffer);
+
+    GLint previousViewport[4];
+    glGetIntegerv(GL_VIEWPORT, previousViewport);
+    GLint previousProgram = 0;
+    glGetIntegerv(GL_CURRENT_PROGRAM, &previousProgram);
+    GLint previousActiveTexture = 0;
+    glGetIntegerv(GL_ACTIVE_TEXTURE, &previousActiveTexture);
+    glActiveTexture(GL_TEXTURE0);
+    GLint previousTexture = 0;
+    glGetIntegerv(GL_TEXTURE_BINDING_2D, &previousTexture);
+    GLint previousArrayBuffer = 0;
+    glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &previousArrayBuffer);
+    const GLboolean blend = glIsEnabled(GL_BLEND);
+    const GLboolean depthTest = glIsEnabled(GL_DEPTH_TEST);
+    const GLboolean scissorTest = glIsEnabled(GL_SCISSOR_TEST);
+    const GLboolean cullFace = glIsEnabled(GL_CULL_FACE);
+
+    const sofa::type::Vec2i targetSize { imageSize[0] / 4, imageSize[1] * 3 / 2 };
+    resizeTarget(m_targetTexture, targetSize, m_targetSize);
+    glBindFramebuffer(GL_FRAMEBUFFER, m_targetFrameBuffer);
+    glViewport(0, 0, targetSize[0], targetSize[1]);
+    glDisable(GL_BLEND);
+    glDisable(GL_DEPTH_TEST);
+    glDisable(GL_SCISSOR_TEST);
+    glDisable(GL_CULL_FACE);
+
+    // the image size only rounds the texture size down: crop rather than resample
+    const bool isCropped = imageSize[0] <= textureSize[0] && textureSize[0] - imageSize[0] < 8
+                        && imageSize[1] <= textureSize[1] && textureSize[1] - imageSize[1] < 4;
+    const sofa::type::Vec2i regionSize = isCropped ? imageSize : textureSize;
+
+    glUseProgram(m_program);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glUniform1i(glGetUniformLocation(m_program, "source"), 0);
+    glUniform2f(glGetUniformLocation(m_program, "sourceSize"), static_cast<float>(textureSize[0]), static_cast<float>(textureSize[1]));
+    glUniform4f(glGetUniformLocation(m_program, "region"), 0.f, 0.f, static_cast<float>(regionSize[0]), static_cast<float>(regionSize[1]));
+    glUniform2f(glGetUniformLocation(m_program, "imageSize"), static_cast<float>(imageSize[0]), static_cast<float>(imageSize[1]));
+
+    // one sample per texel covered by a pixel of the image (see maxNbSamples in the shader)
+    const auto getNbSamples = [](int regionLength, int imageLength)
+    {
+        return static_cast<float>(std::clamp((regionLength + imageLength - 1) / imageLength, 1, 8));
+    };
+    glUniform2f(glGetUniformLocation(m_program, "nbSamples"), getNbSamples(regionSize[0], imageSize[0]), getNbSamples(regionSize[1], imageSize[1]));
+
+    GLint previousVertexArray = 0;
+    if (m_vertexArray != 0)
+    {
+        glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &previousVertexArray);
+        glBindVertexArray(m_vertexArray);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, m_vertexBuffer);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, nullptr);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    glDisableVertexAttribArray(0);
+    if (m_vertexArray != 0)
+    {
+        glBindVertexArray(static_cast<GLuint>(previousVertexArray));
+    }
+
+    // restore the state, except the frame buffer which stays bound for the readback
+    glBindBuffer(GL_ARRAY_BUFFER, static_cast<GLuint>(previousArrayBuffer));
+    glBindTexture(GL_TEXTURE_2D, static_cast<GLuint>(previousTexture));
+    glActiveTexture(static_cast<GLenum>(previousActiveTexture));
+    glUseProgram(static_cast<GLuint>(previousProgram));
+    glViewport(previousViewport[0], previousViewport[1], previousViewport[2], previousViewport[3]);
+    if (blend) glEnable(GL_BLEND);
+    if (depthTest) glEnable(GL_DEPTH_TEST);
+    if (scissorTest) glEnable(GL_SCISSOR_TEST);
+    if (cullFace) glEnable(GL_CULL_FACE);
+
+    return true;
+}
+
+bool YUV420Converter::convertFrameBuffer(int x, int y, int width, int height, const sofa::type::Vec2i& imageSize)
+{
+    if (!isInitialized() || width <= 0 || height <= 0)
+    {
+        return false;
+    }
+
+    GLint previousReadFrameBuffer = 0;
+    glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &previousReadFrameBuffer);
+    GLint previousDrawFrameBuffer = 0;
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previousDrawFrameBuffer);
+    GLint previousTexture = 0;
+    glGetIntegerv(GL_TEXTURE_BINDING_2D, &previousTexture);
+
+    // the texture cannot be sampled from the window directly: copy the rectangle first (on the GPU)
+    resizeTarget(m_sourceTexture, { width, height }, m_sourceSize);
+    glBindTexture(GL_TEXTURE_2D, static_cast<GLuint>(previousTexture));
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, m_sourceFrameBuffer);
+    glBlitFramebuffer(x, y, x + width, y + height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, static_cast<GLuint>(previousDrawFrameBuffer));
+
+    const bool converted = convertTexture(m_sourceTexture, { width, height }, imageSize);
+    if (!converted)
+    {
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, static_cast<GLuint>(previousReadFrameBuffer));
+    }
+    return converted;
+}
+
+void YUV420Converter::unbind()
+{
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, static_cast<GLuint>(m_previousReadFrameBuffer));
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, static_cast<GLuint>(m_previousDrawFrameBuffer));
+}
+
+void YUV420Converter::release()
+{
+    if (!isInitialized())
+    {
+        return;
+    }
+
+    glDeleteFramebuffers(1, &m_targetFrameBuffer);
+    glDeleteFramebuffers(1, &m_sourceFrameBuffer);
+    glDeleteTextures(1, &m_targetTexture);
+    glDeleteTextures(1, &m_sourceTexture);
+    glDeleteBuffers(1, &m_vertexBuffer);
+    if (m_vertexArray != 0)
+    {
+        glDeleteVertexArrays(1, &m_vertexArray);
+    }
+    glDeleteProgram(m_program);
+
+    m_program = m_vertexBuffer = m_vertexArray = 0;
+    m_targetFrameBuffer = m_targetTexture = 0;
+    m_sourceFrameBuffer = m_sourceTexture = 0;
+    m_targetSize = m_sourceSize = { 0, 0 };
+}
+
+} // namespace sofaglfw
@@ -0,0 +1,95 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU General Public License as published by the Free  *
+* Software Foundation; either version 2 of the License, or (at your option)   *
+* any later version.                                                          *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for    *
+* more details.                                                               *
+*                                                                             *
+* You should have received a copy of the GNU General Public License along     *
+* with this program. If not, see <http://www.gnu.org/licenses/>.              *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#pragma once
+#include <SofaGLFW/config.h>
+
+#include <sofa/type/Vec.h>
+
+namespace sofaglfw
+{
+
+/**
+ * @brief Converts a rendered frame to planar YUV420 on the GPU, so that the readback transfers 1.5 bytes
+ * per pixel instead of 4, and the encoder receives the pixel format it writes.
+ *
+ * A fragment shader samples the source texture (averaging the texels covered by each pixel of the image when it
+ * is downscaled) and writes the Y, U and V planes (BT.601, limited range,
+ * rows from top to bottom) into an RGBA8 target, 4 bytes per texel: the target is (width / 4) x (height * 3 / 2)
+ * texels, and can be read back as is with PixelReadbackRing::readFrame(0, 0, width, height, PixelFormat::YUV420).
+ * The image width must be a multiple of 8 and its height a multiple of 4, see getImageSize().
+ *
+ * Requires a current OpenGL context (GLSL 1.20 or a core profile, see GLSLProgram, and frame buffer objects). The GPU resources must be
+ * released explicitly before the context is destroyed.
+ */
+class SOFAGLFW_API YUV420Converter
+{
+public:
+    YUV420Converter() = default;
+    ~YUV420Converter() = default;
+
+    YUV420Converter(const YUV420Converter&) = delete;
+    YUV420Converter& operator=(const YUV420Converter&) = delete;
+
+    /// Largest image size, not larger than the given one, that can be converted.
+    static sofa::type::Vec2i getImageSize(int width, int height);
+
+    /// Compile the shader and create the buffers. Returns false if the context does not support the conversion.
+    bool init();
+    bool isInitialized() const { return m_program != 0; }
+
+    /**
+     * Convert the color texture (of size textureSize) into an image of size imageSize, and bind the converted
+     * frame buffer for reading. The texture is scaled to the image, unless the image size only rounds the
+     * texture size down (see getImageSize()), in which case the bottom-left part of the texture is converted as is.
+     */
+    bool convertTexture(unsigned int texture, const sofa::type::Vec2i& textureSize, const sofa::type::Vec2i& imageSize);
+
+    /// Same as convertTexture, from a rectangle of the frame buffer currently bound for reading (e.g. the window).
+    bool convertFrameBuffer(int x, int y, int width, int height, const sofa::type::Vec2i& imageSize);
+
+    /// Restore the frame buffer bound before the conversion, once the converted frame has been read.
+    void unbind();
+
+    /// Delete the GPU resources. Must be called while the context is current.
+    void release();
+
+private:
+    static void resizeTarget(unsigned int texture, const sofa::type::Vec2i& size, sofa::type::Vec2i& currentSize);
+
+    unsigned int m_program { 0 };
+    unsigned int m_vertexBuffer { 0 };
+    unsigned int m_vertexArray { 0 };
+
+    unsigned int m_targetFrameBuffer { 0 };
+    unsigned int m_targetTexture { 0 };
+    sofa::type::Vec2i m_targetSize { 0, 0 };
+
+    // copy of the frame buffer for convertFrameBuffer, resolving multisampling
+    unsigned int m_sourceFrameBuffer { 0 };
+    unsigned int m_sourceTexture { 0 };
+    sofa::type::Vec2i m_sourceSize { 0, 0 };
+
+    int m_previousReadFrameBuffer { 0 };
+    int m_previousDrawFrameBuffer { 0 };
+};
+
+} // namespace sofaglfw
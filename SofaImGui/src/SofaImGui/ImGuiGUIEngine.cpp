@@ -21,11 +21,13 @@
 ******************************************************************************/
 #include <SofaImGui/ImGuiGUIEngine.h>
 
+#include <cmath>
 #include <iomanip>
 #include <ostream>
 #include <unordered_set>
 #include <type_traits>
 #include <SofaGLFW/SofaGLFWBaseGUI.h>
+#include <SofaGLFW/GLSLProgram.h>
 
 #include <sofa/core/CategoryLibrary.h>
 #include <sofa/helper/logging/LoggingMessageHandler.h>
@@ -77,7 +79,6 @@
 #include <sofa/gui/common/BaseGUI.h>
 #include <sofa/helper/Utils.h>
 #include <sofa/helper/io/File.h>
-#include <sofa/helper/io/STBImage.h>
 #include <sofa/helper/system/PluginManager.h>
 #include <sofa/version.h>
 
@@ -173,7 +174,8 @@ void ImGuiGUIEngine::initBackend(GLFWwindow* glfwWindow)
 #if SOFAIMGUI_FORCE_OPENGL2 == 1
     ImGui_ImplOpenGL2_Init();
 #else
-    ImGui_ImplOpenGL3_Init(nullptr);
+    // the default GLSL version of the backend may be refused by core profile contexts
+    ImGui_ImplOpenGL3_Init(sofaglfw::GLSLProgram::isCoreProfileContext() ? "#version 150" : nullptr);
 #endif // SOFAIMGUI_FORCE_OPENGL2 == 1
 
     float yscale { 1.f };
@@ -206,37 +208,14 @@ void ImGuiGUIEngine::initBackend(GLFWwindow* glfwWindow)
             msg_error("ImGuiGUIEngine") << "Cannot set window size from settings.";
         }
     }
-    
-    glGenBuffers(s_NB_PBOS, m_pbos);
 }
 
 void ImGuiGUIEngine::loadFile(sofaglfw::SofaGLFWBaseGUI* baseGUI, sofa::core::sptr<sofa::simulation::Node>& groot, const std::string filePathName, bool reload)
 {
-    sofa::simulation::node::unload(groot);
+    SOFA_UNUSED(groot);
 
-    groot = sofa::simulation::node::load(filePathName.c_str());
-    if( !groot )
-        groot = sofa::simulation::getSimulation()->createNewGraph("");
-    baseGUI->setSimulation(groot, filePathName);
-    baseGUI->setWindowTitle(nullptr, std::string("SOFA - " + filePathName).c_str());
-    
-    sofa::simulation::node::initRoot(groot.get());
-    auto camera = baseGUI->getCamera();
-    if (camera)
-    {
-        camera->fitBoundingBox(groot->f_bbox.getValue().minBBox(), groot->f_bbox.getValue().maxBBox());
-        baseGUI->changeCamera(camera);
-    }
-
-    if(reload)
-        sofa::simulation::node::initTextures(groot.get()); // do not override OpenGL lights
-    else
-        baseGUI->initVisual();
-    
-    resetCounter();
-
-    // update camera if a sidecar file is present
-    baseGUI->restoreCamera(baseGUI->getCamera());
+    // the scene is loaded in the background, and replaces the current root once initialized
+    baseGUI->loadSceneAsync(filePathName, reload);
 }
 
 void ImGuiGUIEngine::resetCounter()
@@ -316,20 +295,102 @@ void ImGuiGUIEngine::saveScreenshot(sofaglfw::SofaGLFWBaseGUI* baseGUI)
         filterItem.data(), filterItem.size(), nullptr, oss.str().c_str());
     if (result == NFD_OKAY)
     {
-        helper::io::STBImage image;
-        image.init(m_currentFBOSize.first, m_currentFBOSize.second, 1, 1, sofa::helper::io::Image::DataType::UINT32, sofa::helper::io::Image::ChannelFormat::RGBA);
+        // start the transfer of the last drawn scene, collected at the next frame
+        m_fbo->start();
+        m_screenshotReadback.startReadback(0, 0, static_cast<int>(m_currentFBOSize.first), static_cast<int>(m_currentFBOSize.second));
+        m_fbo->stop();
 
-        glBindTexture(GL_TEXTURE_2D, m_fbo->getColorTexture());
+        m_pendingScreenshots.emplace_back(outPath);
+        NFD_FreePath(outPath);
+    }
+}
 
-        // Read the pixel data from the OpenGL texture
-        glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, image.getPixels());
+void ImGuiGUIEngine::savePoster(sofaglfw::SofaGLFWBaseGUI* baseGUI, int width)
+{
+    nfdchar_t *outPath;
+    std::array<nfdfilteritem_t, 1> filterItem{ { {"Image", "qoi,png"} } };
+    const auto sceneFilename = baseGUI->getSceneFileName();
+    std::string baseFilename{};
+    if (!sceneFilename.empty())
+    {
+        std::filesystem::path path(sceneFilename);
+        baseFilename = path.stem().string();
+    }
 
-        glBindTexture(GL_TEXTURE_2D, 0);
+    // qoi by default: the only format written without holding the whole poster in memory
+    const auto viewportSize = baseGUI->getViewPortSize();
+    const int height = static_cast<int>(std::lround(static_cast<double>(width) * viewportSize[1] / std::max(1, viewportSize[0])));
+    std::ostringstream oss{};
+    oss << baseFilename << "_poster_" << width << "x" << height << ".qoi";
 
-        image.save(outPath, 90);
+    nfdresult_t result = NFD_SaveDialog(&outPath,
+        filterItem.data(), filterItem.size(), nullptr, oss.str().c_str());
+    if (result == NFD_OKAY)
+    {
+        baseGUI->requestTiledScreenshot(outPath, width);
+        NFD_FreePath(outPath);
     }
 }
 
+void ImGuiGUIEngine::collectScreenshots()
+{
+    while (!m_pendingScreenshots.empty())
+    {
+        m_screenshotWriter.push(m_screenshotReadback.readPendingFrame(), m_pendingScreenshots.front());
+        m_pendingScreenshots.pop_front();
+    }
+}
+
+void ImGuiGUIEngine::applySettings(sofaglfw::SofaGLFWBaseGUI* baseGUI)
+{
+    applySimulationSettings(baseGUI);
+    applyVideoSettings(baseGUI);
+}
+
+void ImGuiGUIEngine::applySimulationSettings(sofaglfw::SofaGLFWBaseGUI* baseGUI)
+{
+    baseGUI->setIdleWhenPaused(settings->ini.GetBoolValue("Visualization", "idleWhenPaused", true));
+
+    const auto timelineMemoryBudget = static_cast<std::size_t>(std::max(0L, settings->ini.GetLongValue("Simulation", "rewindMemoryBudgetMB", 256))) * 1024 * 1024;
+    if (timelineMemoryBudget != baseGUI->getTimeline().getMemoryBudget())
+    {
+        const auto sceneLock = baseGUI->acquireScene();
+        baseGUI->getTimeline().setMemoryBudget(timelineMemoryBudget);
+    }
+}
+
+void ImGuiGUIEngine::applyVideoSettings(sofaglfw::SofaGLFWBaseGUI* baseGUI)
+{
+    auto& videoEncoder = baseGUI->getVideoEncoder();
+    if (const auto policy = sofaglfw::VideoEncoderThread::policyFromString(settings->ini.GetValue("Video", "queuePolicy", "block")))
+    {
+        videoEncoder.setQueuePolicy(*policy);
+    }
+    videoEncoder.setQueueCapacity(static_cast<std::size_t>(std::max(1L, settings->ini.GetLongValue("Video", "queueCapacity", 8))));
+    m_pixelReadback.setDepth(static_cast<std::size_t>(std::max(2L, settings->ini.GetLongValue("Video", "readbackDepth", 2))));
+
+    const std::string offlineRecordingMode = settings->ini.GetValue("Video", "offlineMode", "off");
+    if (offlineRecordingMode == "steps")
+    {
+        baseGUI->setOfflineRecordingSteps(static_cast<unsigned int>(std::max(1L, settings->ini.GetLongValue("Video", "offlineSteps", 1))));
+    }
+    else if (offlineRecordingMode == "time")
+    {
+        baseGUI->setOfflineRecordingTimeStep(settings->ini.GetDoubleValue("Video", "offlineTimeStep", 1.0 / 60.0));
+    }
+    else
+    {
+        baseGUI->setOfflineRecordingSteps(0);
+    }
+
+    sofaglfw::SofaGLFWBaseGUI::ImageSequenceSettings imageSequence;
+    imageSequence.enabled = settings->ini.GetBoolValue("Video", "imageSequence", false);
+    imageSequence.format = settings->ini.GetValue("Video", "imageFormat", "png");
+    imageSequence.compressionLevel = static_cast<int>(settings->ini.GetLongValue("Video", "imageCompressionLevel", -1));
+    imageSequence.nbThreads = static_cast<std::size_t>(std::max(0L, settings->ini.GetLongValue("Video", "imageThreads", 0)));
+    baseGUI->setImageSequenceSettings(imageSequence);
+}
+
 void ImGuiGUIEngine::startFrame(sofaglfw::SofaGLFWBaseGUI* baseGUI)
 {
     m_localeBackup = std::setlocale(LC_NUMERIC, nullptr);
@@ -337,6 +398,21 @@ void ImGuiGUIEngine::startFrame(sofaglfw::SofaGLFWBaseGUI* baseGUI)
 
     auto groot = baseGUI->getRootNode();
 
+    collectScreenshots();
+
+    if (m_bSimulationSettingsChanged)
+    {
+        applySimulationSettings(baseGUI);
+        m_bSimulationSettingsChanged = false;
+    }
+
+    // the settings edited during a recording are taken into account by the next one
+    if (m_bVideoSettingsChanged && !baseGUI->isVideoRecording())
+    {
+        applyVideoSettings(baseGUI);
+        m_bVideoSettingsChanged = false;
+    }
+
     bool alwaysShowFrame = settings->ini.GetBoolValue("Visualization", "alwaysShowFrame", true);
     if (alwaysShowFrame)
     {
@@ -442,6 +518,7 @@ void ImGuiGUIEngine::startFrame(sofaglfw::SofaGLFWBaseGUI* baseGUI)
 
             if (ImGui::MenuItem(ICON_FA_CIRCLE_XMARK "  Close Simulation"))
             {
+                const auto sceneLock = baseGUI->acquireScene();
                 sofa::simulation::node::unload(groot);
                 baseGUI->setSimulationIsRunning(false);
                 sofa::simulation::node::initRoot(baseGUI->getRootNode().get());
@@ -596,35 +673,172 @@ void ImGuiGUIEngine::startFrame(sofaglfw::SofaGLFWBaseGUI* baseGUI)
             sofa::helper::getWriteOnlyAccessor(groot->animate_).wref() = !animate;
         }
         ImGui::SameLine();
-        if (animate)
+        auto& steppingController = baseGUI->getSteppingController();
+        if (steppingController.isBusy())
         {
-            ImGui::PushItemFlag(ImGuiItemFlags_Disabled, true);
-            ImGui::PushStyleVar(ImGuiStyleVar_Alpha, ImGui::GetStyle().Alpha * 0.5f);
+            // a command (step N, run until...) is in progress
+            if (ImGui::Button(ICON_FA_STOP))
+            {
+                steppingController.cancel();
+            }
+            if (ImGui::IsItemHovered())
+            {
+                ImGui::SetTooltip("Cancel: %s", steppingController.getDescription().c_str());
+            }
         }
-        ImGui::PushButtonRepeat(true);
-        if (ImGui::Button(ICON_FA_FORWARD_STEP))
+        else
         {
-            if (!animate)
+            if (animate)
             {
-                sofa::helper::AdvancedTimer::begin("Animate");
-
-                sofa::simulation::node::animate(groot.get(), groot->getDt());
-                sofa::simulation::node::updateVisual(groot.get());
-
-                sofa::helper::AdvancedTimer::end("Animate");
+                ImGui::PushItemFlag(ImGuiItemFlags_Disabled, true);
+                ImGui::PushStyleVar(ImGuiStyleVar_Alpha, ImGui::GetStyle().Alpha * 0.5f);
+            }
+            ImGui::PushButtonRepeat(true);
+            if (ImGui::Button(ICON_FA_FORWARD_STEP))
+            {
+                if (!animate)
+                {
+                    steppingController.stepN(1);
+                }
+            }
+            ImGui::PopButtonRepeat();
+            if (animate)
+            {
+                ImGui::PopItemFlag();
+                ImGui::PopStyleVar();
             }
         }
-        ImGui::PopButtonRepeat();
-        if (animate)
+        ImGui::SameLine();
+        if (ImGui::Button(ICON_FA_ROTATE_RIGHT))
         {
-            ImGui::PopItemFlag();
-            ImGui::PopStyleVar();
+            // restore the initial state in memory, reload the file only if it was not captured
+            if (!baseGUI->resetSimulation())
+            {
+                groot->setTime(0.);
+                loadFile(baseGUI, groot, baseGUI->getSceneFileName(), true);
+            }
         }
         ImGui::SameLine();
-        if (ImGui::Button(ICON_FA_ROTATE_RIGHT))
         {
-            groot->setTime(0.);
-            loadFile(baseGUI, groot, baseGUI->getSceneFileName(), true);
+            // the timeline is recorded by the steps: it can only be browsed while the simulation is paused
+            const auto& timeline = baseGUI->getTimeline();
+            if (timeline.isEnabled())
+            {
+                ImGui::SetNextItemWidth(ImGui::CalcTextSize("0").x * 25);
+                if (animate)
+                {
+                    ImGui::BeginDisabled();
+                    int lastFrame = 0;
+                    ImGui::SliderInt("##timeline", &lastFrame, 0, 0, ICON_FA_CLOCK_ROTATE_LEFT);
+                    ImGui::EndDisabled();
+                }
+                else if (timeline.getNbFrames() > 0)
+                {
+                    int frame = static_cast<int>(timeline.getCurrentFrame());
+                    const std::string frameTime = ICON_FA_CLOCK_ROTATE_LEFT " " + std::to_string(timeline.getFrameTime(frame));
+                    if (ImGui::SliderInt("##timeline", &frame, 0, static_cast<int>(timeline.getNbFrames()) - 1, frameTime.c_str()))
+                    {
+                        baseGUI->restoreTimelineFrame(static_cast<std::size_t>(frame));
+                    }
+                }
+                if (ImGui::IsItemHovered(ImGuiHoveredFlags_AllowWhenDisabled))
+                {
+                    ImGui::SetTooltip("Rewind: %zu recorded steps (%.1f / %zu MB)", timeline.getNbFrames(),
+                                      static_cast<double>(timeline.getMemorySize()) / (1024.0 * 1024.0), timeline.getMemoryBudget() / (1024 * 1024));
+                }
+                ImGui::SameLine();
+            }
+        }
+        if (ImGui::Button(ICON_FA_GAUGE_HIGH))
+        {
+            ImGui::OpenPopup("simulationRateSettings");
+        }
+        if (ImGui::IsItemHovered())
+        {
+            ImGui::SetTooltip("Simulation and display rates");
+        }
+        if (ImGui::BeginPopup("simulationRateSettings"))
+        {
+            int nbStepsPerFrame = static_cast<int>(baseGUI->getNbStepsPerFrame());
+            ImGui::SetNextItemWidth(ImGui::CalcTextSize("0000000000").x);
+            if (ImGui::InputInt("Steps per frame", &nbStepsPerFrame))
+            {
+                baseGUI->setNbStepsPerFrame(static_cast<unsigned int>(std::max(1, nbStepsPerFrame)));
+            }
+
+            double maxFrameRate = baseGUI->getMaxFrameRate();
+            ImGui::SetNextItemWidth(ImGui::CalcTextSize("0000000000").x);
+            if (ImGui::InputDouble("Max FPS (0: no limit)", &maxFrameRate, 0.0, 0.0, "%.1f"))
+            {
+                baseGUI->setMaxFrameRate(maxFrameRate);
+            }
+
+            ImGui::Separator();
+
+            bool realTime = baseGUI->isRealTime();
+            if (ImGui::Checkbox("Real time", &realTime))
+            {
+                baseGUI->setRealTime(realTime);
+            }
+            if (ImGui::IsItemHovered())
+            {
+                ImGui::SetTooltip("Pace the simulation on the wall-clock time (replaces the steps per frame)");
+            }
+
+            auto& synchronizer = baseGUI->getRealTimeSynchronizer();
+            ImGui::BeginDisabled(!realTime);
+            int policy = static_cast<int>(synchronizer.getCatchUpPolicy());
+            ImGui::SetNextItemWidth(ImGui::CalcTextSize("0000000000").x);
+            if (ImGui::Combo("Catch-up policy", &policy, sofaglfw::RealTimeSynchronizer::policyNames.data(),
+                             static_cast<int>(sofaglfw::RealTimeSynchronizer::policyNames.size())))
+            {
+                synchronizer.setCatchUpPolicy(static_cast<sofaglfw::RealTimeSynchronizer::CatchUpPolicy>(policy));
+            }
+            if (synchronizer.getCatchUpPolicy() == sofaglfw::RealTimeSynchronizer::CatchUpPolicy::Burst)
+            {
+                int maxBurstSteps = static_cast<int>(synchronizer.getMaxBurstSteps());
+                ImGui::SetNextItemWidth(ImGui::CalcTextSize("0000000000").x);
+                if (ImGui::InputInt("Max burst steps", &maxBurstSteps))
+                {
+                    synchronizer.setMaxBurstSteps(static_cast<std::size_t>(std::max(1, maxBurstSteps)));
+                }
+            }
+            ImGui::Text("Real-time factor: %.2f", synchronizer.getRealTimeFactor());
+            ImGui::Text("Accumulated lag: %.3f s (dropped: %.3f s)", synchronizer.getAccumulatedLag(), synchronizer.getDroppedTime());
+            ImGui::EndDisabled();
+
+            ImGui::Separator();
+
+            // stepping commands: the intermediate steps are not drawn
+            ImGui::SetNextItemWidth(ImGui::CalcTextSize("0000000000").x);
+            ImGui::InputInt("##nbSteps", &m_nbStepsToRun);
+            ImGui::SameLine();
+            if (ImGui::Button("Run steps"))
+            {
+                steppingController.stepN(static_cast<std::size_t>(std::max(1, m_nbStepsToRun)));
+            }
+
+            ImGui::SetNextItemWidth(ImGui::CalcTextSize("0000000000").x);
+            ImGui::InputDouble("##untilTime", &m_runUntilTime, 0.0, 0.0, "%.3f");
+            ImGui::SameLine();
+            if (ImGui::Button("Run until time"))
+            {
+                steppingController.runUntilTime(m_runUntilTime);
+            }
+
+            ImGui::SetNextItemWidth(ImGui::CalcTextSize("0000000000").x);
+            ImGui::InputDouble("##wallDuration", &m_runWallDuration, 0.0, 0.0, "%.1f");
+            ImGui::SameLine();
+            if (ImGui::Button("Run for seconds"))
+            {
+                steppingController.runForWallTime(std::max(0.0, m_runWallDuration));
+            }
+            if (ImGui::IsItemHovered())
+            {
+                ImGui::SetTooltip("Wall-clock duration");
+            }
+
+            ImGui::EndPopup();
         }
 
         const auto posX = ImGui::GetCursorPosX();
@@ -637,12 +851,20 @@ void ImGuiGUIEngine::startFrame(sofaglfw::SofaGLFWBaseGUI* baseGUI)
         }
         if (showTime)
         {
-            auto position = ImGui::GetCursorPosX() + ImGui::GetColumnWidth() - ImGui::CalcTextSize("Time: 000.000  ").x
+            const char* timeTextSize = baseGUI->isRealTime() ? "Time: 000.000 (x0.00)  " : "Time: 000.000  ";
+            auto position = ImGui::GetCursorPosX() + ImGui::GetColumnWidth() - ImGui::CalcTextSize(timeTextSize).x
                 - 2 * ImGui::GetStyle().ItemSpacing.x;
             if (showFPSInMenuBar)
                 position -= ImGui::CalcTextSize("1000.0 FPS ").x;
             ImGui::SetCursorPosX(position);
-            ImGui::Text("Time: %.3f", groot->getTime());
+            if (baseGUI->isRealTime())
+            {
+                ImGui::Text("Time: %.3f (x%.2f)", groot->getTime(), baseGUI->getRealTimeSynchronizer().getRealTimeFactor());
+            }
+            else
+            {
+                ImGui::Text("Time: %.3f", groot->getTime());
+            }
             ImGui::SetCursorPosX(posX);
         }
         mainMenuBarSize = ImGui::GetWindowSize();
@@ -666,7 +888,7 @@ void ImGuiGUIEngine::startFrame(sofaglfw::SofaGLFWBaseGUI* baseGUI)
     /***************************************
      * Performances window
      **************************************/
-    windows::showPerformances(windowNamePerformances, io,  winManagerPerformances);
+    windows::showPerformances(windowNamePerformances, io,  winManagerPerformances, baseGUI->getFrameTimingsHistory());
 
 
     /***************************************
@@ -733,6 +955,40 @@ void ImGuiGUIEngine::startFrame(sofaglfw::SofaGLFWBaseGUI* baseGUI)
      * Settings window
      **************************************/
     windows::showSettings(windowNameSettings, settings->ini, winManagerSettings, this);
+
+    /***************************************
+     * Scene loading
+     **************************************/
+    const auto& sceneLoader = baseGUI->getSceneLoader();
+    if (sceneLoader.isBusy() && !ImGui::IsPopupOpen("Loading scene"))
+    {
+        ImGui::OpenPopup("Loading scene");
+    }
+    if (ImGui::BeginPopupModal("Loading scene", nullptr, ImGuiWindowFlags_AlwaysAutoResize | ImGuiWindowFlags_NoMove))
+    {
+        if (!sceneLoader.isBusy())
+        {
+            ImGui::CloseCurrentPopup();
+        }
+        else
+        {
+            const auto phase = sceneLoader.getPhase();
+            const double elapsedTime = sceneLoader.getElapsedTime();
+
+            ImGui::TextUnformatted(sceneLoader.getFileName().c_str());
+            ImGui::Text("%s (%.1f s)", phase == sofaglfw::AsyncSceneLoader::Phase::Loading ? "Loading" : "Initializing", elapsedTime);
+
+            // SOFA does not report the progress of the loading: the bar only shows that it is ongoing
+            ImGui::ProgressBar(static_cast<float>(std::fmod(elapsedTime, 1.0)), ImVec2(ImGui::CalcTextSize("0").x * 40, 0), "");
+        }
+        ImGui::EndPopup();
+    }
+
+    // the idle state of the GUI does not track the Data: a Data edited in a window is drawn as any other change
+    if (ImGui::GetCurrentContext()->ActiveIdHasBeenEditedThisFrame)
+    {
+        baseGUI->redraw();
+    }
     
     ImGui::Render();
 #if SOFAIMGUI_FORCE_OPENGL2 == 1
@@ -748,9 +1004,6 @@ void ImGuiGUIEngine::startFrame(sofaglfw::SofaGLFWBaseGUI* baseGUI)
         ImGui::UpdatePlatformWindows();
         ImGui::RenderPlatformWindowsDefault();
     }
-
-    m_frameCount++;
-
 }
 
 void ImGuiGUIEngine::endFrame()
@@ -758,6 +1011,29 @@ void ImGuiGUIEngine::endFrame()
     std::setlocale(LC_NUMERIC, m_localeBackup.c_str());
 }
 
+bool ImGuiGUIEngine::redrawLastFrame()
+{
+    // the draw data of the last frame stay valid until the next one is started:
+    // the viewport shows the scene frame kept in the FBO, and the inputs are queued by ImGui until the next frame
+    ImDrawData* drawData = ImGui::GetDrawData();
+    if (!drawData)
+    {
+        return false;
+    }
+
+#if SOFAIMGUI_FORCE_OPENGL2 == 1
+    ImGui_ImplOpenGL2_RenderDrawData(drawData);
+#else
+    ImGui_ImplOpenGL3_RenderDrawData(drawData);
+#endif // SOFAIMGUI_FORCE_OPENGL2 == 1
+
+    if (ImGui::GetIO().ConfigFlags & ImGuiConfigFlags_ViewportsEnable)
+    {
+        ImGui::RenderPlatformWindowsDefault();
+    }
+    return true;
+}
+
 void ImGuiGUIEngine::resetView(_ImGuiID dockspace_id, const char* windowNameSceneGraph, const char* winNameSelectionDescription, const char *windowNameLog, const char *windowNameViewport)
 {
     static_assert(std::is_same<_ImGuiID, ImGuiID>::value, "_ImGuiID and ImGuiID types must be identical. _ImGuiID must be adjusted.");
@@ -936,7 +1212,14 @@ void ImGuiGUIEngine::terminate()
 
         NFD_Quit();
         
-        glDeleteBuffers(s_NB_PBOS, m_pbos);
+        // the screenshots still queued are written before their buffers are released
+        collectScreenshots();
+        m_screenshotWriter.stop();
+        m_screenshotReadback.release();
+
+        m_pixelReadback.release();
+        m_yuv420Converter.release();
+        m_frameBufferScaler.release();
 
 #if SOFAIMGUI_FORCE_OPENGL2 == 1
         ImGui_ImplOpenGL2_Shutdown();
@@ -972,50 +1255,56 @@ void ImGuiGUIEngine::setScale(float globalScale)
 
 type::Vec2i ImGuiGUIEngine::getFrameBufferPixels(std::vector<uint8_t>& pixels)
 {
-    int readIndex = m_frameCount % s_NB_PBOS;
-    int processIndex = (m_frameCount + 1) % s_NB_PBOS;
-    
     m_fbo->start();
-    
+
     GLint viewport[4];
     glGetIntegerv(GL_VIEWPORT, viewport);
+    const auto frameSize = m_pixelReadback.read(0, 0, viewport[2], viewport[3], pixels);
+
+    m_fbo->stop();
 
-    if(m_pboSize[0] != viewport[2] || m_pboSize[1] != viewport[3])
+    return frameSize;
+}
+
+sofaglfw::PixelFramePtr ImGuiGUIEngine::readFrameBuffer(const sofa::type::Vec2i& imageSize)
+{
+    m_fbo->start();
+
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    sofaglfw::PixelFramePtr frame;
+    if (imageSize == sofa::type::Vec2i{ 0, 0 } || imageSize == sofa::type::Vec2i{ viewport[2], viewport[3] })
     {
-        // Size for your frame (e.g., 1920x1080 RGBA)
-        int size = viewport[2] * viewport[3] * 4;
+        frame = m_pixelReadback.readFrame(0, 0, viewport[2], viewport[3]);
+    }
+    else if (m_frameBufferScaler.scaleFrameBuffer(0, 0, viewport[2], viewport[3], imageSize))
+    {
+        frame = m_pixelReadback.readFrame(0, 0, imageSize[0], imageSize[1]);
+        m_frameBufferScaler.unbind();
+    }
 
-        for (int i = 0; i < s_NB_PBOS; i++) {
-            glBindBuffer(GL_PIXEL_PACK_BUFFER, m_pbos[i]);
-            glBufferData(GL_PIXEL_PACK_BUFFER, size, NULL, GL_STREAM_READ);
-        }
-        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
-        
-        m_pboSize[0] = viewport[2];
-        m_pboSize[1] = viewport[3];
+    m_fbo->stop();
+
+    return frame;
+}
+
+sofaglfw::PixelFramePtr ImGuiGUIEngine::readFrameBufferYUV420(const sofa::type::Vec2i& imageSize)
+{
+    if (!m_fbo)
+    {
+        return nullptr;
     }
-    
-    glPixelStorei(GL_PACK_ALIGNMENT, 1);
-    
-    // Read to PBO (asynchronous)
-    glBindBuffer(GL_PIXEL_PACK_BUFFER, m_pbos[readIndex]);
-    glReadPixels(0, 0, viewport[2], viewport[3], GL_RGBA, GL_UNSIGNED_BYTE, 0);
 
-    // Map and process previous frame
-    glBindBuffer(GL_PIXEL_PACK_BUFFER, m_pbos[processIndex]);
-    void* data = glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
-    if (data)
+    // the scene texture is converted directly, without going through the frame buffer
+    const sofa::type::Vec2i fboSize { static_cast<int>(m_currentFBOSize.first), static_cast<int>(m_currentFBOSize.second) };
+    if (!m_yuv420Converter.convertTexture(m_fbo->getColorTexture(), fboSize, imageSize))
     {
-        int size = viewport[2] * viewport[3] * 4;
-        pixels.resize(size);
-        memcpy(pixels.data(), data, size);
-        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        return nullptr;
     }
-    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
-    
-    m_fbo->stop();
-        
-    return {viewport[2], viewport[3]};
+    auto frame = m_pixelReadback.readFrame(0, 0, imageSize[0], imageSize[1], sofaglfw::PixelFormat::YUV420);
+    m_yuv420Converter.unbind();
+
+    return frame;
 }
 
 } //namespace sofaimgui
@@ -22,8 +22,14 @@
 #pragma once
 #include <SofaImGui/config.h>
 
+#include <deque>
 #include <memory>
+#include <string>
 #include <SofaGLFW/BaseGUIEngine.h>
+#include <SofaGLFW/PixelReadbackRing.h>
+#include <SofaGLFW/YUV420Converter.h>
+#include <SofaGLFW/FrameBufferScaler.h>
+#include <SofaGLFW/ScreenshotWriter.h>
 #include <sofa/gl/FrameBufferObject.h>
 
 #include "guis/AdditionalGUIRegistry.h"
@@ -51,6 +57,7 @@ public:
 
     void init() override;
     void initBackend(GLFWwindow*) override;
+    void applySettings(sofaglfw::SofaGLFWBaseGUI* baseGUI) override;
     void startFrame(sofaglfw::SofaGLFWBaseGUI*) override;
     void endFrame() override;
     void beforeDraw(GLFWwindow* window) override;
@@ -59,14 +66,31 @@ public:
     bool isTerminated() const override { return m_isTerminated; };
     bool dispatchMouseEvents() override;
     void contentScaleChanged(float xscale, float yscale) override;
+    bool hasPersistentSceneFrame() const override { return true; }
+    bool redrawLastFrame() override;
+    // the OpenGL2 backend of ImGui relies on the fixed-function pipeline
+    bool supportsCoreProfile() const override { return SOFAIMGUI_FORCE_OPENGL2 == 0; }
 
     // apply global scale on the given monitor (if null, it will fetch the main monitor)
     void setScale(float globalScale);
 
+    // the idle and rewind settings have been edited: they are applied to the GUI at the next frame
+    void simulationSettingsChanged() { m_bSimulationSettingsChanged = true; }
+
+    // the Video settings have been edited: they are applied to the GUI before the next recording
+    void videoSettingsChanged() { m_bVideoSettingsChanged = true; }
+
     // reset counters
     void resetCounter() override;
     
     sofa::type::Vec2i getFrameBufferPixels(std::vector<uint8_t>& pixels) override;
+    sofaglfw::PixelFramePtr readFrameBuffer(const sofa::type::Vec2i& imageSize = { 0, 0 }) override;
+    bool initYUV420Readback() override { return m_yuv420Converter.init(); }
+    sofaglfw::PixelFramePtr readFrameBufferYUV420(const sofa::type::Vec2i& imageSize) override;
+    void setFrameBufferReadbackDepth(std::size_t nbFrames) override { m_pixelReadback.setDepth(nbFrames); }
+    void setFrameBufferReadbackTime(double time) override { m_pixelReadback.setFrameTime(time); }
+    void discardPendingFrameBufferPixels() override { m_pixelReadback.discardPendingFrames(); }
+    sofaglfw::PixelFramePtr readPendingFrameBuffer() override { return m_pixelReadback.readPendingFrame(); }
 
     // open file
     void openFile(sofaglfw::SofaGLFWBaseGUI* baseGUI, sofa::core::sptr<sofa::simulation::Node>& groot) override;
@@ -74,8 +98,10 @@ public:
     // load file
     void loadFile(sofaglfw::SofaGLFWBaseGUI* baseGUI, sofa::core::sptr<sofa::simulation::Node>& groot, std::string filePathName, bool reload = false) override;
     
-    // save screenshot
+    // save screenshot: the frame is read back asynchronously, then written by a worker thread
     void saveScreenshot(sofaglfw::SofaGLFWBaseGUI* baseGUI);
+    // save a poster of the given width, rendered tile by tile after the next frame (height following the viewport)
+    void savePoster(sofaglfw::SofaGLFWBaseGUI* baseGUI, int width);
 
 protected:
     std::unique_ptr<sofa::gl::FrameBufferObject> m_fbo;
@@ -112,10 +138,28 @@ protected:
     std::string m_localeBackup;
     unsigned long m_screenshotCounter{0};
     bool m_isTerminated{ false };
-    std::size_t m_frameCount{0};
-    static inline constexpr int s_NB_PBOS = 2;
-    GLuint m_pbos[s_NB_PBOS];
-    sofa::type::Vec2i m_pboSize;
+    sofaglfw::PixelReadbackRing m_pixelReadback;
+    sofaglfw::YUV420Converter m_yuv420Converter;
+    sofaglfw::FrameBufferScaler m_frameBufferScaler;
+
+    // apply the idle and rewind settings of the ini file to the GUI (idle when paused, rewind memory budget)
+    void applySimulationSettings(sofaglfw::SofaGLFWBaseGUI* baseGUI);
+    bool m_bSimulationSettingsChanged { false };
+
+    // apply the Video settings of the ini file to the GUI (encoder queue, readback depth, offline recording, image sequence)
+    void applyVideoSettings(sofaglfw::SofaGLFWBaseGUI* baseGUI);
+    bool m_bVideoSettingsChanged { false };
+
+    // values entered in the stepping commands of the rate popup
+    int m_nbStepsToRun { 100 };
+    double m_runUntilTime { 1.0 };
+    double m_runWallDuration { 10.0 };  ///< in seconds
+
+    // hand the screenshots read back since the previous frame to the writer
+    void collectScreenshots();
+    sofaglfw::PixelReadbackRing m_screenshotReadback;
+    std::deque<std::string> m_pendingScreenshots;
+    sofaglfw::ScreenshotWriter m_screenshotWriter;
 };
 
 } // namespace sofaimgui
@@ -24,14 +24,70 @@
 #include <imgui_internal.h> //imgui_internal.h is included in order to use the DockspaceBuilder API (which is still in development)
 #include <sofa/type/vector.h>
 
+#include <algorithm>
+#include <array>
+
 
 namespace windows
 {
 
 
+namespace
+{
+    void showFrameTimings(const sofaglfw::FrameTimingsHistory& frameTimingsHistory)
+    {
+        // statistics over the last two seconds at 60 FPS
+        const auto records = frameTimingsHistory.getLatest(120);
+        if (records.empty())
+        {
+            return;
+        }
+
+        static const std::array<std::pair<const char*, double sofaglfw::FrameTimings::*>, 8> phases {{
+            {"Step", &sofaglfw::FrameTimings::step},
+            {"Draw", &sofaglfw::FrameTimings::draw},
+            {"Selection", &sofaglfw::FrameTimings::selection},
+            {"GUI", &sofaglfw::FrameTimings::gui},
+            {"Readback", &sofaglfw::FrameTimings::readback},
+            {"Swap", &sofaglfw::FrameTimings::swap},
+            {"Events", &sofaglfw::FrameTimings::poll},
+            {"Total", &sofaglfw::FrameTimings::total}
+        }};
+
+        if (ImGui::BeginTable("frameTimings", 3, ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerH))
+        {
+            ImGui::TableSetupColumn("Main loop phase");
+            ImGui::TableSetupColumn("Average (ms)");
+            ImGui::TableSetupColumn("Max (ms)");
+            ImGui::TableHeadersRow();
+
+            for (const auto& [name, phase] : phases)
+            {
+                double sum = 0.0;
+                double max = 0.0;
+                for (const auto& record : records)
+                {
+                    sum += record.*phase;
+                    max = std::max(max, record.*phase);
+                }
+
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::TextUnformatted(name);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.3f", 1000.0 * sum / static_cast<double>(records.size()));
+                ImGui::TableNextColumn();
+                ImGui::Text("%.3f", 1000.0 * max);
+            }
+            ImGui::EndTable();
+        }
+    }
+} // namespace
+
     void showPerformances(const char *const &windowNamePerformances,
                           const ImGuiIO &io,
-                          WindowState& winManagerPerformances)
+                          WindowState& winManagerPerformances,
+                          const sofaglfw::FrameTimingsHistory& frameTimingsHistory)
     {
         ImGuiContext& g = *GImGui;
         if (*winManagerPerformances.getStatePtr()) {
@@ -49,6 +105,8 @@ namespace windows
                 }
                 ImGui::PlotLines("Frame Times", msArray.data(), msArray.size(), 0, nullptr, FLT_MAX, FLT_MAX,
                                  ImVec2(0, 100));
+
+                showFrameTimings(frameTimingsHistory);
             }
             ImGui::End();
         }
@@ -26,6 +26,7 @@
 
 #include <memory>
 #include <SofaGLFW/BaseGUIEngine.h>
+#include <SofaGLFW/FrameTimings.h>
 #include <sofa/gl/FrameBufferObject.h>
 
 #include <imgui.h>
@@ -44,9 +45,11 @@ namespace windows
          * @param windowNamePerformances The name of the Performance window.
          * @param io The ImGuiIO structure containing ImGui's I/O configuration settings.
          * @param isPerformancesWindowOpen A reference to a boolean flag indicating if the Performance window is open.
+         * @param frameTimingsHistory The timings of the phases of the last iterations of the main loop.
          */
          void showPerformances(const char* const& windowNamePerformances,
                                const ImGuiIO& io,
-                               WindowState& winManagerPerformances);
+                               WindowState& winManagerPerformances,
+                               const sofaglfw::FrameTimingsHistory& frameTimingsHistory);
 
 } // namespace sofaimgui
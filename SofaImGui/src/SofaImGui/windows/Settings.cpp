@@ -97,6 +97,140 @@ namespace windows
                     [[maybe_unused]] SI_Error rc = ini.SaveFile(sofaimgui::AppIniFile::getAppIniFile().c_str());
                 }
                 
+                bool idleWhenPaused = ini.GetBoolValue("Visualization", "idleWhenPaused", true);
+                if (ImGui::Checkbox("Idle when paused", &idleWhenPaused))
+                {
+                    ini.SetBoolValue("Visualization", "idleWhenPaused", idleWhenPaused);
+                    engine->simulationSettingsChanged();
+                    [[maybe_unused]] SI_Error rc = ini.SaveFile(sofaimgui::AppIniFile::getAppIniFile().c_str());
+                }
+                if (ImGui::IsItemHovered())
+                {
+                    ImGui::SetTooltip("While the simulation is paused, redraw only when something changes to save CPU");
+                }
+
+                int rewindMemoryBudget = static_cast<int>(ini.GetLongValue("Simulation", "rewindMemoryBudgetMB", 256));
+                if (ImGui::InputInt("Rewind memory budget (MB, 0: disabled)", &rewindMemoryBudget, 64, 256))
+                {
+                    ini.SetLongValue("Simulation", "rewindMemoryBudgetMB", std::max(0, rewindMemoryBudget));
+                    engine->simulationSettingsChanged();
+                    [[maybe_unused]] SI_Error rc = ini.SaveFile(sofaimgui::AppIniFile::getAppIniFile().c_str());
+                }
+
+                const auto videoQueuePolicy = sofaglfw::VideoEncoderThread::policyFromString(ini.GetValue("Video", "queuePolicy", "block"));
+                int videoQueuePolicyIndex = static_cast<int>(videoQueuePolicy.value_or(sofaglfw::VideoEncoderThread::QueuePolicy::Block));
+                if (ImGui::Combo("Video queue policy", &videoQueuePolicyIndex, sofaglfw::VideoEncoderThread::policyNames.data(),
+                                 static_cast<int>(sofaglfw::VideoEncoderThread::policyNames.size())))
+                {
+                    ini.SetValue("Video", "queuePolicy", sofaglfw::VideoEncoderThread::policyNames[videoQueuePolicyIndex]);
+                    engine->videoSettingsChanged();
+                    [[maybe_unused]] SI_Error rc = ini.SaveFile(sofaimgui::AppIniFile::getAppIniFile().c_str());
+                }
+                if (ImGui::IsItemHovered())
+                {
+                    ImGui::SetTooltip("When the video encoder cannot keep up: wait for it (block), skip frames (drop), or capture fewer frames evenly (degrade)");
+                }
+
+                int videoQueueCapacity = static_cast<int>(ini.GetLongValue("Video", "queueCapacity", 8));
+                if (ImGui::InputInt("Video queue capacity (frames)", &videoQueueCapacity))
+                {
+                    ini.SetLongValue("Video", "queueCapacity", std::max(1, videoQueueCapacity));
+                    engine->videoSettingsChanged();
+                    [[maybe_unused]] SI_Error rc = ini.SaveFile(sofaimgui::AppIniFile::getAppIniFile().c_str());
+                }
+
+                int readbackDepth = static_cast<int>(ini.GetLongValue("Video", "readbackDepth", 2));
+                if (ImGui::InputInt("Video readback depth (frames)", &readbackDepth))
+                {
+                    ini.SetLongValue("Video", "readbackDepth", std::max(2, readbackDepth));
+                    engine->videoSettingsChanged();
+                    [[maybe_unused]] SI_Error rc = ini.SaveFile(sofaimgui::AppIniFile::getAppIniFile().c_str());
+                }
+                if (ImGui::IsItemHovered())
+                {
+                    ImGui::SetTooltip("Number of frames read back asynchronously: more frames hide the transfers better, at the cost of latency");
+                }
+
+                static constexpr std::array<const char*, 3> offlineRecordingModes { "off", "steps", "time" };
+                const std::string offlineRecordingMode = ini.GetValue("Video", "offlineMode", "off");
+                const auto offlineRecordingModeIt = std::find(offlineRecordingModes.begin(), offlineRecordingModes.end(), offlineRecordingMode);
+                int offlineRecordingModeIndex = (offlineRecordingModeIt != offlineRecordingModes.end()) ? static_cast<int>(std::distance(offlineRecordingModes.begin(), offlineRecordingModeIt)) : 0;
+                if (ImGui::Combo("Offline video recording", &offlineRecordingModeIndex, offlineRecordingModes.data(), static_cast<int>(offlineRecordingModes.size())))
+                {
+                    ini.SetValue("Video", "offlineMode", offlineRecordingModes[offlineRecordingModeIndex]);
+                    engine->videoSettingsChanged();
+                    [[maybe_unused]] SI_Error rc = ini.SaveFile(sofaimgui::AppIniFile::getAppIniFile().c_str());
+                }
+                if (ImGui::IsItemHovered())
+                {
+                    ImGui::SetTooltip("Record exactly one frame every N steps (steps) or every given simulated time (time), computing the steps as fast as possible: the video does not depend on the machine load");
+                }
+                if (offlineRecordingModeIndex == 1)
+                {
+                    int offlineRecordingSteps = static_cast<int>(ini.GetLongValue("Video", "offlineSteps", 1));
+                    if (ImGui::InputInt("Steps per video frame", &offlineRecordingSteps))
+                    {
+                        ini.SetLongValue("Video", "offlineSteps", std::max(1, offlineRecordingSteps));
+                        engine->videoSettingsChanged();
+                        [[maybe_unused]] SI_Error rc = ini.SaveFile(sofaimgui::AppIniFile::getAppIniFile().c_str());
+                    }
+                }
+                else if (offlineRecordingModeIndex == 2)
+                {
+                    double offlineRecordingTimeStep = ini.GetDoubleValue("Video", "offlineTimeStep", 1.0 / 60.0);
+                    if (ImGui::InputDouble("Simulated time per video frame (s)", &offlineRecordingTimeStep, 0.0, 0.0, "%.4f"))
+                    {
+                        ini.SetDoubleValue("Video", "offlineTimeStep", std::max(1e-6, offlineRecordingTimeStep));
+                        engine->videoSettingsChanged();
+                        [[maybe_unused]] SI_Error rc = ini.SaveFile(sofaimgui::AppIniFile::getAppIniFile().c_str());
+                    }
+                }
+
+                bool recordImageSequence = ini.GetBoolValue("Video", "imageSequence", false);
+                if (ImGui::Checkbox("Record image sequence", &recordImageSequence))
+                {
+                    ini.SetBoolValue("Video", "imageSequence", recordImageSequence);
+                    engine->videoSettingsChanged();
+                    [[maybe_unused]] SI_Error rc = ini.SaveFile(sofaimgui::AppIniFile::getAppIniFile().c_str());
+                }
+                if (ImGui::IsItemHovered())
+                {
+                    ImGui::SetTooltip("Write every recorded frame as a numbered image in a new directory, instead of a video");
+                }
+                if (recordImageSequence)
+                {
+                    static constexpr std::array<const char*, 5> imageFormats { "png", "jpg", "bmp", "tga", "qoi" };
+                    const std::string imageFormat = ini.GetValue("Video", "imageFormat", "png");
+                    const auto imageFormatIt = std::find(imageFormats.begin(), imageFormats.end(), imageFormat);
+                    int imageFormatIndex = (imageFormatIt != imageFormats.end()) ? static_cast<int>(std::distance(imageFormats.begin(), imageFormatIt)) : 0;
+                    if (ImGui::Combo("Image format", &imageFormatIndex, imageFormats.data(), static_cast<int>(imageFormats.size())))
+                    {
+                        ini.SetValue("Video", "imageFormat", imageFormats[imageFormatIndex]);
+                        engine->videoSettingsChanged();
+                        [[maybe_unused]] SI_Error rc = ini.SaveFile(sofaimgui::AppIniFile::getAppIniFile().c_str());
+                    }
+
+                    int imageCompressionLevel = static_cast<int>(ini.GetLongValue("Video", "imageCompressionLevel", -1));
+                    if (ImGui::InputInt("Image compression level", &imageCompressionLevel))
+                    {
+                        ini.SetLongValue("Video", "imageCompressionLevel", std::clamp(imageCompressionLevel, -1, 100));
+                        engine->videoSettingsChanged();
+                        [[maybe_unused]] SI_Error rc = ini.SaveFile(sofaimgui::AppIniFile::getAppIniFile().c_str());
+                    }
+                    if (ImGui::IsItemHovered())
+                    {
+                        ImGui::SetTooltip("zlib level (0-9) for png, quality (1-100) for jpg, -1 for the default");
+                    }
+
+                    int imageThreads = static_cast<int>(ini.GetLongValue("Video", "imageThreads", 0));
+                    if (ImGui::InputInt("Image compression threads (0: all)", &imageThreads))
+                    {
+                        ini.SetLongValue("Video", "imageThreads", std::max(0, imageThreads));
+                        engine->videoSettingsChanged();
+                        [[maybe_unused]] SI_Error rc = ini.SaveFile(sofaimgui::AppIniFile::getAppIniFile().c_str());
+                    }
+                }
+
                 bool rememberWindowPosition = ini.GetBoolValue("Window", "rememberWindowPosition", true);
                 if (ImGui::Checkbox("Remember window position", &rememberWindowPosition))
                 {
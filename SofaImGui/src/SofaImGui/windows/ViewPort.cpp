@@ -35,7 +35,9 @@
 #include <SofaImGui/widgets/DisplayFlagsWidget.h>
 #include <sofa/component/visual/VisualStyle.h>
 
+#include <algorithm>
 #include <iomanip>
+#include <string>
 namespace windows
 {
 
@@ -119,7 +121,53 @@ namespace windows
                         baseGUI->toggleVideoRecording();
                     }
                     ImGui::PopStyleColor(2);
-                    
+
+                    if (baseGUI->isVideoRecording())
+                    {
+                        const auto& encoder = baseGUI->getVideoEncoder();
+                        const auto stats = encoder.getStats();
+                        ImGui::SameLine();
+                        ImGui::Text("queue %zu/%zu | dropped %zu | encode %.1f ms", stats.queueDepth, encoder.getQueueCapacity(),
+                                    stats.nbDroppedFrames, stats.averageEncodeTime * 1e3);
+                        if (ImGui::IsItemHovered())
+                        {
+                            ImGui::SetTooltip("%zu frames encoded, '%s' policy when the queue is full (1 frame out of %zu captured)",
+                                              stats.nbEncodedFrames, sofaglfw::VideoEncoderThread::toString(encoder.getQueuePolicy()), stats.captureInterval);
+                        }
+                    }
+                    else
+                    {
+                        // the profile of the next recording
+                        ImGui::SameLine();
+                        ImGui::SetNextItemWidth(ImGui::GetFontSize() * 6);
+                        if (ImGui::BeginCombo("##recordingProfile", baseGUI->getRecordingProfile().name.c_str()))
+                        {
+                            for (const auto& profile : baseGUI->getRecordingProfiles())
+                            {
+                                const bool isSelected = profile.name == baseGUI->getRecordingProfile().name;
+                                if (ImGui::Selectable(profile.name.c_str(), isSelected))
+                                {
+                                    baseGUI->setRecordingProfile(profile.name);
+                                }
+                                if (ImGui::IsItemHovered())
+                                {
+                                    const auto size = profile.getVideoSize(baseGUI->getViewPortSize()[0], baseGUI->getViewPortSize()[1]);
+                                    ImGui::SetTooltip("%dx%d, %u fps, %.1f Mbit/s, %s %s", size[0], size[1], profile.framerate, profile.bitrate * 1e-6,
+                                                      profile.extension.c_str(), profile.pixelFormat.c_str());
+                                }
+                                if (isSelected)
+                                {
+                                    ImGui::SetItemDefaultFocus();
+                                }
+                            }
+                            ImGui::EndCombo();
+                        }
+                        if (ImGui::IsItemHovered())
+                        {
+                            ImGui::SetTooltip("Recording profile");
+                        }
+                    }
+
                     if (ImGui::Button(ICON_FA_GEAR))
                     {
                         ImGui::OpenPopup("viewportSettingsMenu");
@@ -205,6 +253,32 @@ namespace windows
                             sofaimgui::showDisplayFlagsWidget(visualStyle->d_displayFlags);
                             ImGui::EndMenu();
                         }
+                        if (ImGui::BeginMenu(ICON_FA_IMAGE " Save Poster"))
+                        {
+                            // rendered tile by tile: not limited by the size of the frame buffers
+                            const int viewportWidth = std::max(1, baseGUI->getViewPortSize()[0]);
+                            const int viewportHeight = std::max(1, baseGUI->getViewPortSize()[1]);
+                            int posterWidth = 0;
+                            for (const int scale : { 2, 4, 8 })
+                            {
+                                const std::string label = std::to_string(scale) + "x  (" + std::to_string(scale * viewportWidth) + "x" + std::to_string(scale * viewportHeight) + ")";
+                                if (ImGui::Selectable(label.c_str()))
+                                {
+                                    posterWidth = scale * viewportWidth;
+                                }
+                            }
+                            if (ImGui::Selectable("16384 px wide"))
+                            {
+                                posterWidth = 16384;
+                            }
+                            if (posterWidth > 0)
+                            {
+                                auto guiEnginePtr = std::static_pointer_cast<sofaimgui::ImGuiGUIEngine>(baseGUI->getGUIEngine());
+                                if (guiEnginePtr)
+                                    guiEnginePtr->savePoster(baseGUI, posterWidth);
+                            }
+                            ImGui::EndMenu();
+                        }
 
                         ImGui::EndPopup();
                     }
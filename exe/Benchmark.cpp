@@ -0,0 +1,222 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU General Public License as published by the Free  *
+* Software Foundation; either version 2 of the License, or (at your option)   *
+* any later version.                                                          *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for    *
+* more details.                                                               *
+*                                                                             *
+* You should have received a copy of the GNU General Public License along     *
+* with this program. If not, see <http://www.gnu.org/licenses/>.              *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include "Benchmark.h"
+
+#include <sofa/config.h>
+#include <sofa/helper/logging/Messaging.h>
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <numeric>
+
+namespace sofaglfw
+{
+
+namespace
+{
+
+std::string toJSONString(const std::string& str)
+{
+    std::string escaped = "\"";
+    for (const char c : str)
+    {
+        switch (c)
+        {
+            case '"': escaped += "\\\""; break;
+            case '\\': escaped += "\\\\"; break;
+            case '\n': escaped += "\\n"; break;
+            case '\t': escaped += "\\t"; break;
+            default: escaped += c; break;
+        }
+    }
+    return escaped + "\"";
+}
+
+void writeStatistics(std::ostream& out, const Benchmark::Statistics& statistics)
+{
+    out << "{ \"min\": " << statistics.min
+        << ", \"mean\": " << statistics.mean
+        << ", \"median\": " << statistics.median
+        << ", \"p90\": " << statistics.p90
+        << ", \"p99\": " << statistics.p99
+        << ", \"max\": " << statistics.max << " }";
+}
+
+void writeSamples(std::ostream& out, const std::vector<double>& samples)
+{
+    out << "[";
+    for (std::size_t i = 0; i < samples.size(); ++i)
+    {
+        out << (i > 0 ? ", " : "") << samples[i];
+    }
+    out << "]";
+}
+
+} // namespace
+
+Benchmark::Statistics Benchmark::computeStatistics(std::vector<double> samples)
+{
+    Statistics statistics;
+    if (samples.empty())
+    {
+        return statistics;
+    }
+
+    std::sort(samples.begin(), samples.end());
+
+    const auto percentile = [&samples](double p)
+    {
+        const auto rank = static_cast<std::size_t>(std::ceil(p * static_cast<double>(samples.size())));
+        return samples[std::clamp<std::size_t>(rank, 1, samples.size()) - 1];
+    };
+
+    statistics.min = samples.front();
+    statistics.max = samples.back();
+    statistics.mean = std::accumulate(samples.begin(), samples.end(), 0.0) / static_cast<double>(samples.size());
+    statistics.median = percentile(0.5);
+    statistics.p90 = percentile(0.9);
+    statistics.p99 = percentile(0.99);
+    return statistics;
+}
+
+Benchmark::Benchmark(const std::string& sceneFileName, std::size_t nbWarmUpIterations, std::size_t nbIterations, bool isRendering)
+    : m_sceneFileName(sceneFileName)
+    , m_nbWarmUpIterations(nbWarmUpIterations)
+    , m_nbIterations(nbIterations)
+    , m_isRendering(isRendering)
+{
+}
+
+void Benchmark::startRun()
+{
+    m_runs.emplace_back();
+    m_runs.back().stepTimes.reserve(m_nbIterations);
+    if (m_isRendering)
+    {
+        m_runs.back().drawTimes.reserve(m_nbIterations);
+        m_runs.back().guiTimes.reserve(m_nbIterations);
+        m_runs.back().swapTimes.reserve(m_nbIterations);
+    }
+    m_runStart = std::chrono::steady_clock::now();
+}
+
+void Benchmark::addIteration(const SofaGLFWBaseGUI::FrameTimings& timings)
+{
+    if (m_runs.empty())
+    {
+        return;
+    }
+
+    auto& run = m_runs.back();
+    run.nbSteps += timings.nbSteps;
+    if (timings.nbSteps > 0)
+    {
+        run.stepTimes.push_back(timings.step / static_cast<double>(timings.nbSteps));
+    }
+    if (m_isRendering)
+    {
+        run.drawTimes.push_back(timings.draw + timings.selection);
+        run.guiTimes.push_back(timings.gui);
+        run.swapTimes.push_back(timings.swap);
+    }
+}
+
+void Benchmark::endRun()
+{
+    if (!m_runs.empty())
+    {
+        m_runs.back().totalTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_runStart).count();
+    }
+}
+
+std::vector<double> Benchmark::gather(std::vector<double> Run::* times) const
+{
+    std::vector<double> samples;
+    for (const auto& run : m_runs)
+    {
+        samples.insert(samples.end(), (run.*times).begin(), (run.*times).end());
+    }
+    return samples;
+}
+
+void Benchmark::printSummary() const
+{
+    const auto stepStatistics = computeStatistics(gather(&Run::stepTimes));
+    msg_info("SofaGLFW") << "Benchmark: " << m_runs.size() << " run(s) of " << m_nbIterations << " iterations. Step time (ms): "
+                         << "min " << stepStatistics.min * 1e3
+                         << ", median " << stepStatistics.median * 1e3
+                         << ", p90 " << stepStatistics.p90 * 1e3
+                         << ", p99 " << stepStatistics.p99 * 1e3
+                         << ", max " << stepStatistics.max * 1e3;
+}
+
+bool Benchmark::writeReport(const std::string& fileName) const
+{
+    std::ofstream out(fileName);
+    if (!out.is_open())
+    {
+        msg_error("SofaGLFW") << "Cannot write the benchmark report in " << fileName;
+        return false;
+    }
+
+    // all the times are in seconds
+    out.precision(9);
+    out << "{\n";
+    out << "  \"scene\": " << toJSONString(m_sceneFileName) << ",\n";
+    out << "  \"sofa_version\": " << toJSONString(SOFA_VERSION_STR) << ",\n";
+    out << "  \"rendering\": " << (m_isRendering ? "true" : "false") << ",\n";
+    out << "  \"warmup_iterations\": " << m_nbWarmUpIterations << ",\n";
+    out << "  \"iterations\": " << m_nbIterations << ",\n";
+    out << "  \"repeats\": " << m_runs.size() << ",\n";
+
+    out << "  \"step_time\": ";
+    writeStatistics(out, computeStatistics(gather(&Run::stepTimes)));
+    if (m_isRendering)
+    {
+        out << ",\n  \"draw_time\": ";
+        writeStatistics(out, computeStatistics(gather(&Run::drawTimes)));
+        out << ",\n  \"gui_time\": ";
+        writeStatistics(out, computeStatistics(gather(&Run::guiTimes)));
+        out << ",\n  \"swap_time\": ";
+        writeStatistics(out, computeStatistics(gather(&Run::swapTimes)));
+    }
+
+    out << ",\n  \"runs\": [\n";
+    for (std::size_t i = 0; i < m_runs.size(); ++i)
+    {
+        const auto& run = m_runs[i];
+        out << "    { \"total_time\": " << run.totalTime
+            << ", \"steps\": " << run.nbSteps
+            << ", \"steps_per_second\": " << (run.totalTime > 0.0 ? static_cast<double>(run.nbSteps) / run.totalTime : 0.0)
+            << ", \"step_times\": ";
+        writeSamples(out, run.stepTimes);
+        out << " }" << (i + 1 < m_runs.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n";
+    out << "}\n";
+
+    msg_info("SofaGLFW") << "Benchmark report written in " << fileName;
+    return out.good();
+}
+
+} // namespace sofaglfw
@@ -0,0 +1,87 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU General Public License as published by the Free  *
+* Software Foundation; either version 2 of the License, or (at your option)   *
+* any later version.                                                          *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for    *
+* more details.                                                               *
+*                                                                             *
+* You should have received a copy of the GNU General Public License along     *
+* with this program. If not, see <http://www.gnu.org/licenses/>.              *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#pragma once
+
+#include <SofaGLFW/SofaGLFWBaseGUI.h>
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace sofaglfw
+{
+
+/**
+ * Collects the timings of each iteration of the benchmark runs of runSofaGLFW,
+ * and writes their statistics in a JSON report.
+ */
+class Benchmark
+{
+public:
+    struct Statistics
+    {
+        double min {0.0};
+        double mean {0.0};
+        double median {0.0};
+        double p90 {0.0};
+        double p99 {0.0};
+        double max {0.0};
+    };
+
+    /// Nearest-rank percentiles of the samples. All zeros if there are no samples.
+    static Statistics computeStatistics(std::vector<double> samples);
+
+    Benchmark(const std::string& sceneFileName, std::size_t nbWarmUpIterations, std::size_t nbIterations, bool isRendering);
+
+    void startRun();
+    void addIteration(const SofaGLFWBaseGUI::FrameTimings& timings);
+    void endRun();
+
+    /// Print a summary of the step times of all the runs
+    void printSummary() const;
+
+    bool writeReport(const std::string& fileName) const;
+
+private:
+    struct Run
+    {
+        double totalTime {0.0};
+        std::size_t nbSteps {0};
+        std::vector<double> stepTimes;
+        std::vector<double> drawTimes;
+        std::vector<double> guiTimes;
+        std::vector<double> swapTimes;
+    };
+
+    std::vector<double> gather(std::vector<double> Run::* times) const;
+
+    std::string m_sceneFileName;
+    std::size_t m_nbWarmUpIterations {0};
+    std::size_t m_nbIterations {0};
+    bool m_isRendering {false};
+
+    std::vector<Run> m_runs;
+    std::chrono::steady_clock::time_point m_runStart;
+};
+
+} // namespace sofaglfw
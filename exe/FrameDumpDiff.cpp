@@ -0,0 +1,296 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU General Public License as published by the Free  *
+* Software Foundation; either version 2 of the License, or (at your option)   *
+* any later version.                                                          *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for    *
+* more details.                                                               *
+*                                                                             *
+* You should have received a copy of the GNU General Public License along     *
+* with this program. If not, see <http://www.gnu.org/licenses/>.              *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include "FrameDumpDiff.h"
+
+#include <SofaGLFW/QOIImage.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cctype>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SOFAGLFW_FRAMEDUMPDIFF_SSE2
+#endif
+
+namespace sofaglfw
+{
+
+namespace
+{
+
+/// The number ending the name of a frame (e.g. 1001 for "frame_1001.qoi"), or -1 if there is none.
+long long getFrameNumber(const std::filesystem::path& frame)
+{
+    const std::string stem = frame.stem().string();
+    std::size_t digitsBegin = stem.size();
+    while (digitsBegin > 0 && std::isdigit(static_cast<unsigned char>(stem[digitsBegin - 1])))
+    {
+        --digitsBegin;
+    }
+    if (digitsBegin == stem.size() || stem.size() - digitsBegin > 18)
+    {
+        return -1;
+    }
+    return std::stoll(stem.substr(digitsBegin));
+}
+
+/// Frame order: by number, then by name. The counter is only padded to 4 digits, so "_10000" follows "_9999".
+bool isFrameBefore(const std::filesystem::path& a, const std::filesystem::path& b)
+{
+    const long long numberA = getFrameNumber(a);
+    const long long numberB = getFrameNumber(b);
+    if (numberA != numberB)
+    {
+        return numberA < numberB;
+    }
+    return a.filename() < b.filename();
+}
+
+} // namespace
+
+std::uint64_t FrameDumpDiff::computeSquaredError(const std::uint8_t* a, const std::uint8_t* b, std::size_t nbBytes)
+{
+    std::uint64_t squaredError = 0;
+    std::size_t i = 0;
+
+#ifdef SOFAGLFW_FRAMEDUMPDIFF_SSE2
+    // 16 bytes per iteration: the differences are widened to 16 bits, squared and summed in pairs by madd.
+    // A 32-bit lane gains at most 2 * 2 * 255^2 per iteration, so the lanes are flushed every 2048 iterations.
+    constexpr std::size_t blockSize = 16 * 2048;
+    const std::size_t vectorEnd = nbBytes - nbBytes % 16;
+    const __m128i zero = _mm_setzero_si128();
+    while (i < vectorEnd)
+    {
+        const std::size_t blockEnd = std::min(vectorEnd, i + blockSize);
+        __m128i sum = zero;
+        for (; i < blockEnd; i += 16)
+        {
+            const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+            const __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+            const __m128i low = _mm_sub_epi16(_mm_unpacklo_epi8(va, zero), _mm_unpacklo_epi8(vb, zero));
+            const __m128i high = _mm_sub_epi16(_mm_unpackhi_epi8(va, zero), _mm_unpackhi_epi8(vb, zero));
+            sum = _mm_add_epi32(sum, _mm_madd_epi16(low, low));
+            sum = _mm_add_epi32(sum, _mm_madd_epi16(high, high));
+        }
+
+        alignas(16) std::uint32_t lanes[4];
+        _mm_store_si128(reinterpret_cast<__m128i*>(lanes), sum);
+        squaredError += std::uint64_t(lanes[0]) + lanes[1] + lanes[2] + lanes[3];
+    }
+#endif
+
+    for (; i < nbBytes; ++i)
+    {
+        const int difference = int(a[i]) - int(b[i]);
+        squaredError += static_cast<std::uint64_t>(difference * difference);
+    }
+    return squaredError;
+}
+
+double FrameDumpDiff::computePSNR(std::uint64_t squaredError, std::size_t nbBytes)
+{
+    if (squaredError == 0 || nbBytes == 0)
+    {
+        return std::numeric_limits<double>::infinity();
+    }
+    const double meanSquaredError = static_cast<double>(squaredError) / static_cast<double>(nbBytes);
+    return 10.0 * std::log10(255.0 * 255.0 / meanSquaredError);
+}
+
+FrameDumpDiff::FrameDumpDiff(const std::filesystem::path& referenceDirectory, const std::filesystem::path& candidateDirectory, double minPSNR)
+    : m_referenceDirectory(referenceDirectory)
+    , m_candidateDirectory(candidateDirectory)
+    , m_minPSNR(minPSNR)
+{
+}
+
+std::vector<std::filesystem::path> FrameDumpDiff::listFrames(const std::filesystem::path& directory)
+{
+    std::vector<std::filesystem::path> frames;
+    for (const auto& entry : std::filesystem::directory_iterator(directory))
+    {
+        if (entry.is_regular_file() && entry.path().extension() == ".qoi")
+        {
+            frames.push_back(entry.path());
+        }
+    }
+    std::sort(frames.begin(), frames.end(), isFrameBefore);
+    return frames;
+}
+
+bool FrameDumpDiff::compare(std::size_t nbThreads)
+{
+    std::error_code error;
+    if (!std::filesystem::is_directory(m_referenceDirectory, error) || !std::filesystem::is_directory(m_candidateDirectory, error))
+    {
+        std::cerr << "Both dumps must be directories of QOI images: " << m_referenceDirectory << ", " << m_candidateDirectory << std::endl;
+        return false;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+
+    const auto referenceFrames = listFrames(m_referenceDirectory);
+    const auto candidateFrames = listFrames(m_candidateDirectory);
+
+    // the frames are paired by file name, so that a frame missing in one of the dumps does not shift the next pairs
+    m_results.clear();
+    std::vector<std::size_t> commonFrames;
+    std::size_t r = 0, c = 0;
+    while (r < referenceFrames.size() || c < candidateFrames.size())
+    {
+        FrameResult result;
+        if (c == candidateFrames.size() || (r < referenceFrames.size() && isFrameBefore(referenceFrames[r], candidateFrames[c])))
+        {
+            result.referenceFileName = referenceFrames[r++].filename().string();
+        }
+        else if (r == referenceFrames.size() || isFrameBefore(candidateFrames[c], referenceFrames[r]))
+        {
+            result.candidateFileName = candidateFrames[c++].filename().string();
+        }
+        else
+        {
+            result.referenceFileName = referenceFrames[r++].filename().string();
+            result.candidateFileName = candidateFrames[c++].filename().string();
+            commonFrames.push_back(m_results.size());
+        }
+        // a frame missing in one of the dumps diverges
+        result.isDiverging = result.referenceFileName.empty() || result.candidateFileName.empty();
+        m_results.push_back(result);
+    }
+
+    // the frames are decoded and compared independently
+    std::atomic<std::size_t> nextFrame {0};
+    const auto compareFrames = [&]()
+    {
+        sofa::type::Vec2i referenceSize, candidateSize;
+        std::vector<std::uint8_t> referencePixels, candidatePixels;
+        for (std::size_t i = nextFrame++; i < commonFrames.size(); i = nextFrame++)
+        {
+            FrameResult& result = m_results[commonFrames[i]];
+            result.isLoaded = QOIImage::load((m_referenceDirectory / result.referenceFileName).string(), referenceSize, referencePixels)
+                           && QOIImage::load((m_candidateDirectory / result.candidateFileName).string(), candidateSize, candidatePixels);
+            result.isSameSize = result.isLoaded && referenceSize == candidateSize;
+            if (result.isSameSize)
+            {
+                result.squaredError = computeSquaredError(referencePixels.data(), candidatePixels.data(), referencePixels.size());
+                result.psnr = computePSNR(result.squaredError, referencePixels.size());
+            }
+            result.isDiverging = !result.isSameSize || result.psnr < m_minPSNR;
+        }
+    };
+
+    if (nbThreads == 0)
+    {
+        nbThreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    nbThreads = std::min(nbThreads, std::max<std::size_t>(1, commonFrames.size()));
+    std::vector<std::thread> threads;
+    for (std::size_t i = 1; i < nbThreads; ++i)
+    {
+        threads.emplace_back(compareFrames);
+    }
+    compareFrames();
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    m_compareTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return true;
+}
+
+std::size_t FrameDumpDiff::getFirstDivergingFrame() const
+{
+    const auto it = std::find_if(m_results.begin(), m_results.end(), [](const FrameResult& result) { return result.isDiverging; });
+    return static_cast<std::size_t>(std::distance(m_results.begin(), it));
+}
+
+void FrameDumpDiff::printReport(bool printEachFrame) const
+{
+    double minPSNR = std::numeric_limits<double>::infinity();
+    std::size_t nbDivergingFrames = 0;
+    for (std::size_t i = 0; i < m_results.size(); ++i)
+    {
+        const FrameResult& result = m_results[i];
+        minPSNR = std::min(minPSNR, result.psnr);
+        nbDivergingFrames += result.isDiverging ? 1 : 0;
+
+        if (!printEachFrame && !result.isDiverging)
+        {
+            continue;
+        }
+
+        std::cout << "frame " << std::setw(6) << i << "  ";
+        if (result.referenceFileName.empty() || result.candidateFileName.empty())
+        {
+            std::cout << (result.referenceFileName.empty() ? result.candidateFileName : result.referenceFileName)
+                      << " missing in the " << (result.referenceFileName.empty() ? "reference" : "candidate") << " dump";
+        }
+        else if (!result.isLoaded)
+        {
+            std::cout << "cannot be read (" << result.referenceFileName << ", " << result.candidateFileName << ")";
+        }
+        else if (!result.isSameSize)
+        {
+            std::cout << "different sizes";
+        }
+        else if (result.squaredError == 0)
+        {
+            std::cout << "identical";
+        }
+        else
+        {
+            std::cout << "PSNR " << std::fixed << std::setprecision(2) << result.psnr << " dB" << std::defaultfloat;
+        }
+        std::cout << (result.isDiverging ? "  <- diverging" : "") << "\n";
+    }
+
+    std::cout << m_results.size() << " frames compared in " << std::setprecision(3) << m_compareTime << " s, "
+              << nbDivergingFrames << " diverging, minimum PSNR ";
+    if (std::isinf(minPSNR))
+        std::cout << "inf";
+    else
+        std::cout << std::fixed << std::setprecision(2) << minPSNR << std::defaultfloat << " dB";
+    std::cout << "\n";
+
+    const std::size_t firstDivergingFrame = getFirstDivergingFrame();
+    if (firstDivergingFrame < m_results.size())
+    {
+        const FrameResult& result = m_results[firstDivergingFrame];
+        std::cout << "First diverging frame: " << firstDivergingFrame << " ("
+                  << (result.referenceFileName.empty() ? result.candidateFileName : result.referenceFileName) << ")\n";
+    }
+    else
+    {
+        std::cout << "No diverging frame\n";
+    }
+    std::cout << std::flush;
+}
+
+} // namespace sofaglfw
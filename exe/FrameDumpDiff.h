@@ -0,0 +1,87 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU General Public License as published by the Free  *
+* Software Foundation; either version 2 of the License, or (at your option)   *
+* any later version.                                                          *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for    *
+* more details.                                                               *
+*                                                                             *
+* You should have received a copy of the GNU General Public License along     *
+* with this program. If not, see <http://www.gnu.org/licenses/>.              *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#pragma once
+
+#include <sofa/type/Vec.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace sofaglfw
+{
+
+/**
+ * Compares two frame dumps (directories of QOI images, e.g. written by --image_sequence=qoi) frame by frame,
+ * for the render regression tests: the frames are paired by file name, in the order of their numbers, and
+ * compared with their PSNR. Used by the diff command of runSofaGLFW.
+ */
+class FrameDumpDiff
+{
+public:
+    struct FrameResult
+    {
+        std::string referenceFileName;
+        std::string candidateFileName;
+        bool isLoaded {false};      ///< both frames were read
+        bool isSameSize {false};
+        std::uint64_t squaredError {0};
+        double psnr {std::numeric_limits<double>::infinity()};  ///< in dB, infinite for identical frames
+        bool isDiverging {false};
+    };
+
+    /// Sum of the squared differences of the bytes (SSE2 when available).
+    static std::uint64_t computeSquaredError(const std::uint8_t* a, const std::uint8_t* b, std::size_t nbBytes);
+
+    /// PSNR of 8-bit values, in dB. Infinite if squaredError is 0.
+    static double computePSNR(std::uint64_t squaredError, std::size_t nbBytes);
+
+    /// Frames with a PSNR lower than minPSNR diverge. The default only accepts identical frames.
+    FrameDumpDiff(const std::filesystem::path& referenceDirectory, const std::filesystem::path& candidateDirectory,
+                  double minPSNR = std::numeric_limits<double>::infinity());
+
+    /// Compare all the frames, on nbThreads threads (0: one per hardware thread). Returns false if a dump cannot be read.
+    bool compare(std::size_t nbThreads = 0);
+
+    const std::vector<FrameResult>& getResults() const { return m_results; }
+
+    /// Index of the first diverging frame, or the number of frames if there is none. Missing frames diverge.
+    std::size_t getFirstDivergingFrame() const;
+
+    void printReport(bool printEachFrame) const;
+
+    bool hasDiverged() const { return getFirstDivergingFrame() < m_results.size(); }
+
+private:
+    static std::vector<std::filesystem::path> listFrames(const std::filesystem::path& directory);
+
+    std::filesystem::path m_referenceDirectory;
+    std::filesystem::path m_candidateDirectory;
+    double m_minPSNR;
+    std::vector<FrameResult> m_results;
+    double m_compareTime {0.0};
+};
+
+} // namespace sofaglfw
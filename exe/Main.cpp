@@ -23,6 +23,8 @@
 
 #include <cxxopts.hpp>
 #include <SofaGLFW/SofaGLFWBaseGUI.h>
+#include "Benchmark.h"
+#include "FrameDumpDiff.h"
 
 #include <sofa/helper/logging/LoggingMessageHandler.h>
 #include <sofa/helper/system/FileRepository.h>
@@ -37,10 +39,93 @@
 
 #include <sofa/helper/system/PluginManager.h>
 
+#include <algorithm>
 #include <chrono>
+#include <functional>
+#include <limits>
+#include <string>
+
+namespace
+{
+
+/// Compute the steps of the stepping commands without any rendering, one at a time. Returns the number of steps computed.
+std::size_t runHeadless(sofaglfw::SteppingController& steppingController, sofa::simulation::Node* groot, bool updateVisual,
+                        const std::function<void(const sofaglfw::SofaGLFWBaseGUI::FrameTimings&)>& frameTimingsCallback)
+{
+    std::size_t nbSteps = 0;
+    while (steppingController.isBusy())
+    {
+        const auto stepStart = std::chrono::steady_clock::now();
+        const std::size_t nbStepsDone = steppingController.execute(groot, 0.0, 1, [groot]()
+        {
+            sofa::simulation::node::animate(groot, groot->getDt());
+        });
+        if (nbStepsDone == 0)
+        {
+            continue;
+        }
+        nbSteps += nbStepsDone;
+
+        if (updateVisual)
+        {
+            sofa::simulation::node::updateVisual(groot);
+        }
+
+        if (frameTimingsCallback)
+        {
+            sofaglfw::SofaGLFWBaseGUI::FrameTimings frameTimings;
+            frameTimings.nbSteps = nbStepsDone;
+            frameTimings.step = std::chrono::duration<double>(std::chrono::steady_clock::now() - stepStart).count();
+            frameTimingsCallback(frameTimings);
+        }
+    }
+    return nbSteps;
+}
+
+/// runSofaGLFW diff <reference> <candidate>: compare two frame dumps. Returns 1 if they diverge, 2 on error.
+int runFrameDumpDiff(int argc, char** argv)
+{
+    cxxopts::Options options("SofaGLFW diff", "Compare two frame dumps (directories of QOI images, see --image_sequence=qoi) frame by frame");
+    options.add_options()
+        ("reference", "directory of the reference frames", cxxopts::value<std::string>())
+        ("candidate", "directory of the compared frames", cxxopts::value<std::string>())
+        ("min_psnr", "set minimum PSNR (in dB) of the frames which do not diverge. By default, the frames must be identical", cxxopts::value<double>())
+        ("j,threads", "set number of threads decoding the frames (0: one per hardware thread)", cxxopts::value<std::size_t>()->default_value("0"))
+        ("diverging_only", "only print the diverging frames", cxxopts::value<bool>()->default_value("false"))
+        ("h,help", "print usage")
+        ;
+
+    options.parse_positional({"reference", "candidate"});
+    const auto result = options.parse(argc, argv);
+
+    if (result.count("help") || !result.count("reference") || !result.count("candidate"))
+    {
+        std::cout << options.help() << std::endl;
+        return result.count("help") ? 0 : 2;
+    }
+
+    const double minPSNR = result.count("min_psnr") ? result["min_psnr"].as<double>() : std::numeric_limits<double>::infinity();
+    sofaglfw::FrameDumpDiff diff(result["reference"].as<std::string>(), result["candidate"].as<std::string>(), minPSNR);
+    if (!diff.compare(result["threads"].as<std::size_t>()))
+    {
+        return 2;
+    }
+    diff.printReport(!result["diverging_only"].as<bool>());
+
+    return diff.hasDiverged() ? 1 : 0;
+}
+
+} // namespace
 
 int main(int argc, char** argv)
 {
+    if (argc > 1 && std::string(argv[1]) == "diff")
+    {
+        int diffArgc = argc - 1;
+        char** diffArgv = argv + 1;
+        return runFrameDumpDiff(diffArgc, diffArgv);
+    }
+
     std::vector<std::string> pluginsToLoad;
 
     cxxopts::Options options("SofaGLFW", "A simple GUI based on GLFW for SOFA");
@@ -50,7 +135,28 @@ int main(int argc, char** argv)
         ("s,fullscreen", "set full screen at startup", cxxopts::value<bool>()->default_value("false"))
         ("l,load", "load given plugins as a comma-separated list. Example: -l SofaPython3", cxxopts::value<std::vector<std::string> >(pluginsToLoad))
         ("m,msaa_samples", "set number of samples for multisample anti-aliasing (MSAA)", cxxopts::value<unsigned short>()->default_value("0"))
+        ("gl_core_profile", "create an OpenGL 3.3 core profile context, without the fixed-function pipeline (experimental: the components drawing with the legacy pipeline are not drawn)", cxxopts::value<bool>()->default_value("false"))
         ("n,nb_iterations", "set number of iterations to run (batch mode)", cxxopts::value<std::size_t>()->default_value("0"))
+        ("until_time", "run until the simulation time reaches the given time, without drawing the intermediate steps, then quit (batch mode)", cxxopts::value<double>())
+        ("headless", "run the batch mode without window nor OpenGL context: only the simulation steps are computed (requires -n)", cxxopts::value<bool>()->default_value("false"))
+        ("update_visual", "update the visual models after each step in headless mode", cxxopts::value<bool>()->default_value("false"))
+        ("benchmark", "run the batch mode as a benchmark and write the JSON report of the timings in the given file (requires -n)", cxxopts::value<std::string>())
+        ("warmup", "set number of iterations computed before the benchmark runs, not measured", cxxopts::value<std::size_t>()->default_value("10"))
+        ("repeats", "set number of benchmark runs of -n iterations", cxxopts::value<std::size_t>()->default_value("1"))
+        ("t,simulation_thread", "run the simulation steps on a dedicated thread, decoupled from the rendering", cxxopts::value<bool>()->default_value("false"))
+        ("steps_per_frame", "set number of simulation steps computed before each displayed frame", cxxopts::value<unsigned int>()->default_value("1"))
+        ("max_fps", "set maximum number of displayed frames per second (0: no limit)", cxxopts::value<double>()->default_value("0"))
+        ("real_time", "pace the simulation on the wall-clock time, with the given catch-up policy when late: drop, burst or slowdown. Example: --real_time=drop", cxxopts::value<std::string>()->implicit_value("burst"))
+        ("max_burst_steps", "set maximum number of steps computed at once to catch up with the wall-clock time (burst policy)", cxxopts::value<std::size_t>()->default_value("10"))
+        ("readback_depth", "set number of frames read back asynchronously while recording a video, i.e. the latency of the recorded frames plus one", cxxopts::value<std::size_t>()->default_value("2"))
+        ("recording_profile", "set recording profile of the videos: viewport, preview, half, 1080p, 2160p, or a profile declared in etc/SofaGLFW.ini", cxxopts::value<std::string>())
+        ("image_sequence", "record numbered images in the given format (png, jpg, bmp, tga, qoi) instead of a video, compressed on all the cores. Example: --image_sequence=jpg", cxxopts::value<std::string>()->implicit_value("png"))
+        ("image_compression", "set compression level of the image sequence: zlib level (0-9) for png, quality (1-100) for jpg, -1 for the default", cxxopts::value<int>()->default_value("-1"))
+        ("record_offline", "record a video from the start, with exactly one frame every N steps, or every given simulated time with an 's' suffix, computed as fast as possible. Example: --record_offline=10 or --record_offline=0.04s", cxxopts::value<std::string>())
+        ("frame_stream", "publish the frames drawn into a shared-memory ring with the given name, read by other local processes. Example: --frame_stream=/my_frames", cxxopts::value<std::string>()->implicit_value("/sofaglfw_frames"))
+        ("frame_stream_slots", "set number of frames kept in the shared-memory ring", cxxopts::value<std::size_t>()->default_value("3"))
+        ("poster", "save a poster of the first frame, rendered tile by tile, into the given file (.qoi is written with a bounded memory). Example: --poster=poster.qoi", cxxopts::value<std::string>())
+        ("poster_width", "set width of the poster in pixels, the height following the aspect ratio of the viewport", cxxopts::value<int>()->default_value("16384"))
         ("h,help", "print usage")
         ;
 
@@ -72,13 +178,32 @@ int main(int argc, char** argv)
     // create an instance of SofaGLFWGUI
     // linked with the simulation
     sofaglfw::SofaGLFWBaseGUI glfwGUI;
-    
-    auto nbMSAASamples = result["msaa_samples"].as<unsigned short>();
-    if (!glfwGUI.init(nbMSAASamples))
+
+    // headless: neither GLFW nor OpenGL, only the simulation steps
+    const bool isHeadless = result["headless"].as<bool>();
+    const bool isBenchmark = result.count("benchmark") > 0;
+    auto targetNbIterations = result["nb_iterations"].as<std::size_t>();
+    const bool hasUntilTime = result.count("until_time") > 0;
+    if (hasUntilTime && (targetNbIterations > 0 || isBenchmark))
+    {
+        std::cerr << "The option --until_time cannot be combined with -n nor --benchmark, quitting..." << std::endl;
+        return 1;
+    }
+    if ((isHeadless || isBenchmark) && targetNbIterations == 0 && !hasUntilTime)
     {
-        // Initialization failed
-        std::cerr << "Could not initialize GLFW, quitting..." << std::endl;
-        return 0;
+        std::cerr << "The headless and benchmark modes require a number of iterations (-n), quitting..." << std::endl;
+        return 1;
+    }
+
+    if (!isHeadless)
+    {
+        auto nbMSAASamples = result["msaa_samples"].as<unsigned short>();
+        if (!glfwGUI.init(nbMSAASamples))
+        {
+            // Initialization failed
+            std::cerr << "Could not initialize GLFW, quitting..." << std::endl;
+            return 0;
+        }
     }
 
     for (const auto& plugin : pluginsToLoad)
@@ -97,62 +222,205 @@ int main(int argc, char** argv)
         groot = sofa::simulation::getSimulation()->createNewGraph("");
     }
 
-    glfwGUI.setSimulation(groot, fileName);
-
-    bool isFullScreen = result["fullscreen"].as<bool>();
-    sofa::type::Vec2i resolution{ 800, 600};
-    sofa::component::setting::ViewerSetting* viewerConf;
-    groot->get(viewerConf, sofa::core::objectmodel::BaseContext::SearchRoot);
-    if (viewerConf)
+    if (!isHeadless)
     {
-        if (viewerConf->d_fullscreen.getValue())
-        {
-            isFullScreen = true;
-        }
-        else
+        glfwGUI.setSimulation(groot, fileName);
+
+        bool isFullScreen = result["fullscreen"].as<bool>();
+        sofa::type::Vec2i resolution{ 800, 600};
+        sofa::component::setting::ViewerSetting* viewerConf;
+        groot->get(viewerConf, sofa::core::objectmodel::BaseContext::SearchRoot);
+        if (viewerConf)
         {
-            resolution = viewerConf->d_resolution.getValue();
+            if (viewerConf->d_fullscreen.getValue())
+            {
+                isFullScreen = true;
+            }
+            else
+            {
+                resolution = viewerConf->d_resolution.getValue();
+            }
         }
-    }
 
-    // create a SofaGLFW window
-    glfwGUI.createWindow(resolution[0], resolution[1], "SofaGLFW", isFullScreen);
+        glfwGUI.setCoreProfile(result["gl_core_profile"].as<bool>());
+
+        // create a SofaGLFW window
+        glfwGUI.createWindow(resolution[0], resolution[1], "SofaGLFW", isFullScreen);
+    }
 
     sofa::simulation::node::initRoot(groot.get());
 
-    auto targetNbIterations = result["nb_iterations"].as<std::size_t>();
     if (targetNbIterations > 0)
     {
-        msg_info("SofaGLFW") << "Batch mode: computing " << targetNbIterations << " iterations.";
+        msg_info("SofaGLFW") << (isHeadless ? "Headless batch mode" : "Batch mode") << ": computing " << targetNbIterations << " iterations.";
         startAnim = true;
     }
+    else if (hasUntilTime)
+    {
+        // the stepping commands run whether the simulation is animated or not
+        msg_info("SofaGLFW") << (isHeadless ? "Headless batch mode" : "Batch mode") << ": running until t = " << result["until_time"].as<double>() << " s.";
+    }
 
     if (startAnim)
         groot->setAnimate(true);
 
-    glfwGUI.initVisual();
-
-    //Background
-    sofa::component::setting::BackgroundSetting* background;
-    groot->get(background, sofa::core::objectmodel::BaseContext::SearchRoot);
-    if (background)
+    glfwGUI.setSimulationThreaded(result["simulation_thread"].as<bool>());
+    glfwGUI.setNbStepsPerFrame(result["steps_per_frame"].as<unsigned int>());
+    glfwGUI.setMaxFrameRate(result["max_fps"].as<double>());
+    if (result.count("real_time"))
     {
-        if (background->d_image.getValue().empty())
-            glfwGUI.setWindowBackgroundColor(background->d_color.getValue());
+        const auto& policyName = result["real_time"].as<std::string>();
+        if (const auto policy = sofaglfw::RealTimeSynchronizer::policyFromString(policyName))
+        {
+            glfwGUI.getRealTimeSynchronizer().setCatchUpPolicy(*policy);
+            glfwGUI.getRealTimeSynchronizer().setMaxBurstSteps(result["max_burst_steps"].as<std::size_t>());
+            glfwGUI.setRealTime(true);
+        }
         else
-            glfwGUI.setWindowBackgroundImage(background->d_image.getFullPath());
+        {
+            msg_error("SofaGLFW") << "Unknown real-time catch-up policy '" << policyName << "'. Available policies: drop, burst, slowdown.";
+        }
     }
 
-    // Run the main loop
-    const auto currentTime = std::chrono::steady_clock::now();
-    const auto currentNbIterations = glfwGUI.runLoop(targetNbIterations);
+    if (!isHeadless)
+    {
+        glfwGUI.getGUIEngine()->setFrameBufferReadbackDepth(result["readback_depth"].as<std::size_t>());
 
-    const auto totalTime = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - currentTime).count() / 1000.0;
+        if (result.count("frame_stream"))
+        {
+            sofaglfw::SofaGLFWBaseGUI::FrameStreamSettings frameStream;
+            frameStream.name = result["frame_stream"].as<std::string>();
+            frameStream.nbSlots = result["frame_stream_slots"].as<std::size_t>();
+            glfwGUI.startFrameStream(frameStream);
+        }
 
-    // measurements only make sense in batch mode
-    if (targetNbIterations > 0)
+        if (result.count("poster"))
+        {
+            glfwGUI.requestTiledScreenshot(result["poster"].as<std::string>(), result["poster_width"].as<int>());
+        }
+
+        if (result.count("recording_profile"))
+        {
+            glfwGUI.setRecordingProfile(result["recording_profile"].as<std::string>());
+        }
+
+        if (result.count("image_sequence"))
+        {
+            sofaglfw::SofaGLFWBaseGUI::ImageSequenceSettings imageSequence;
+            imageSequence.enabled = true;
+            imageSequence.format = result["image_sequence"].as<std::string>();
+            imageSequence.compressionLevel = result["image_compression"].as<int>();
+            glfwGUI.setImageSequenceSettings(imageSequence);
+        }
+
+        if (result.count("record_offline"))
+        {
+            const auto& interval = result["record_offline"].as<std::string>();
+            try
+            {
+                if (!interval.empty() && interval.back() == 's')
+                {
+                    glfwGUI.setOfflineRecordingTimeStep(std::stod(interval.substr(0, interval.size() - 1)));
+                }
+                else
+                {
+                    glfwGUI.setOfflineRecordingSteps(static_cast<unsigned int>(std::stoul(interval)));
+                }
+            }
+            catch (const std::exception&)
+            {
+                msg_error("SofaGLFW") << "Invalid offline recording interval '" << interval << "'. Expected a number of steps (e.g. 10) or a simulated time (e.g. 0.04s).";
+            }
+
+            if (glfwGUI.isOfflineRecordingEnabled())
+            {
+                glfwGUI.setVideoRecordingAtStartup(true);
+            }
+        }
+        glfwGUI.initVisual();
+
+        //Background
+        sofa::component::setting::BackgroundSetting* background;
+        groot->get(background, sofa::core::objectmodel::BaseContext::SearchRoot);
+        if (background)
+        {
+            if (background->d_image.getValue().empty())
+                glfwGUI.setWindowBackgroundColor(background->d_color.getValue());
+            else
+                glfwGUI.setWindowBackgroundImage(background->d_image.getFullPath());
+        }
+    }
+
+    const bool updateVisual = result["update_visual"].as<bool>();
+    std::function<void(const sofaglfw::SofaGLFWBaseGUI::FrameTimings&)> frameTimingsCallback;
+    auto& steppingController = glfwGUI.getSteppingController();
+    const auto runIterations = [&](std::size_t nbIterations)
     {
-        msg_info("SofaGLFW") << currentNbIterations << " iterations done in " << totalTime << " s ( " << (static_cast<double>(currentNbIterations) / totalTime) << " FPS)." << msgendl;
+        if (isHeadless)
+        {
+            steppingController.stepN(nbIterations);
+            return runHeadless(steppingController, groot.get(), updateVisual, frameTimingsCallback);
+        }
+        return glfwGUI.runLoop(nbIterations);
+    };
+
+    if (isBenchmark)
+    {
+        // every iteration computes exactly one step, as fast as possible, on the main thread
+        glfwGUI.setSimulationThreaded(false);
+        glfwGUI.setNbStepsPerFrame(1);
+        glfwGUI.setMaxFrameRate(0.0);
+        glfwGUI.setRealTime(false);
+
+        sofaglfw::Benchmark benchmark(fileName, result["warmup"].as<std::size_t>(), targetNbIterations, !isHeadless);
+
+        if (const auto nbWarmUpIterations = result["warmup"].as<std::size_t>(); nbWarmUpIterations > 0)
+        {
+            runIterations(nbWarmUpIterations);
+        }
+
+        frameTimingsCallback = [&benchmark](const sofaglfw::SofaGLFWBaseGUI::FrameTimings& timings)
+        {
+            benchmark.addIteration(timings);
+        };
+        glfwGUI.setFrameTimingsCallback(frameTimingsCallback);
+
+        const auto nbRepeats = std::max<std::size_t>(1, result["repeats"].as<std::size_t>());
+        for (std::size_t i = 0; i < nbRepeats; ++i)
+        {
+            benchmark.startRun();
+            runIterations(targetNbIterations);
+            benchmark.endRun();
+        }
+        glfwGUI.setFrameTimingsCallback(nullptr);
+
+        benchmark.printSummary();
+        benchmark.writeReport(result["benchmark"].as<std::string>());
+    }
+    else
+    {
+        // Run the main loop
+        const auto currentTime = std::chrono::steady_clock::now();
+        std::size_t currentNbIterations = 0;
+        if (hasUntilTime)
+        {
+            steppingController.runUntilTime(result["until_time"].as<double>());
+            currentNbIterations = isHeadless
+                ? runHeadless(steppingController, groot.get(), updateVisual, frameTimingsCallback)
+                : glfwGUI.runSteppingCommands();
+        }
+        else
+        {
+            currentNbIterations = runIterations(targetNbIterations);
+        }
+
+        const auto totalTime = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - currentTime).count() / 1000.0;
+
+        // measurements only make sense in batch mode
+        if (targetNbIterations > 0 || hasUntilTime)
+        {
+            msg_info("SofaGLFW") << currentNbIterations << " iterations done in " << totalTime << " s ( " << (static_cast<double>(currentNbIterations) / totalTime) << " FPS)." << msgendl;
+        }
     }
     
     if (groot != nullptr)